@@ -0,0 +1,122 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <inlines/eval.h>
+#include "HandDistributions.h"
+#include "AliasTable.h"
+#include "RandomEngine.h"
+
+AliasTable::AliasTable(void)
+    : m_liveCount(0)
+{
+}
+
+AliasTable::~AliasTable(void)
+{
+}
+
+void AliasTable::Clear(void)
+{
+    m_prob.clear();
+    m_alias.clear();
+    m_liveCount = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Vose's method. Weights are scaled so that they average 1; every column i
+// keeps m_prob[i] of its own mass and borrows the rest from m_alias[i], one
+// of the columns that had more than its share.
+///////////////////////////////////////////////////////////////////////////////
+int AliasTable::Build(const vector<double>& weights)
+{
+    Clear();
+
+    int count = weights.size();
+    double total = 0.0;
+    for (int i = 0; i < count; i++) {
+        if (weights[i] > 0.0) {
+            total += weights[i];
+            m_liveCount++;
+        }
+    }
+
+    if (m_liveCount == 0)
+        return 0;
+
+    m_prob.resize(count);
+    m_alias.resize(count);
+
+    vector<int> small, large;
+    for (int i = 0; i < count; i++) {
+        m_prob[i] = weights[i] > 0.0 ? weights[i] * count / total : 0.0;
+        m_alias[i] = i;
+        if (m_prob[i] < 1.0)
+            small.push_back(i);
+        else
+            large.push_back(i);
+    }
+
+    while (!small.empty() && !large.empty()) {
+        int less = small.back(); small.pop_back();
+        int more = large.back();
+        m_alias[less] = more;
+        m_prob[more] -= 1.0 - m_prob[less];
+        if (m_prob[more] < 1.0) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+
+    // Whatever is left over is 1 up to rounding error. A zero weight column
+    // must still never be drawn, so point it at a live one.
+    int live = 0;
+    while (weights[live] <= 0.0)
+        live++;
+    for (size_t i = 0; i < large.size(); i++)
+        m_prob[large[i]] = 1.0;
+    for (size_t i = 0; i < small.size(); i++) {
+        if (weights[small[i]] > 0.0)
+            m_prob[small[i]] = 1.0;
+        else
+            m_alias[small[i]] = live;
+    }
+
+    return m_liveCount;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// One 53 bit draw picks the column (integer part) and decides between the
+// column and its alias (fractional part).
+///////////////////////////////////////////////////////////////////////////////
+int AliasTable::Sample(RandomEngine& rand) const
+{
+    return Sample(rand());
+}
+
+int AliasTable::Sample(double u) const
+{
+    u *= m_prob.size();
+    int column = (int)u;
+    if (column >= (int)m_prob.size())
+        column = m_prob.size() - 1;
+
+    return (u - column) < m_prob[column] ? column : m_alias[column];
+}
@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+class RandomEngine;
+
+///////////////////////////////////////////////////////////////////////////////
+// Walker/Vose alias table for drawing an index with probability proportional
+// to its weight in O(1). Building the table is O(n); entries with a weight of
+// zero are never drawn.
+///////////////////////////////////////////////////////////////////////////////
+class AliasTable
+{
+public:
+	AliasTable();
+	virtual ~AliasTable(void);
+
+	// Returns the number of entries that can be drawn (weight > 0).
+	int Build(const vector<double>& weights);
+	void Clear();
+	int Sample(RandomEngine& rand) const;
+	int Sample(double u) const;	// u uniform on [0, 1)
+
+	bool IsEmpty() const { return m_prob.empty(); }
+	int GetSize() const { return m_prob.size(); }
+	int GetLiveCount() const { return m_liveCount; }
+
+private:
+	vector<double> m_prob;
+	vector<int> m_alias;
+	int m_liveCount;
+};
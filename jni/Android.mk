@@ -4,15 +4,42 @@ include $(CLEAR_VARS)
 
 LOCAL_MODULE    := poker-handdist
 LOCAL_CPPFLAGS  := -std=c++11
+# Uncomment to leave the Omaha ordering tables out of the library and load
+# them at startup with OrderingTables::Load() (see tools/ordering2bin.cpp).
+#LOCAL_CPPFLAGS += -DHANDDIST_EXTERNAL_OMAHA_ORDERINGS
+# Uncomment to collect the counters and timings of HandDistMetrics.
+#LOCAL_CPPFLAGS += -DHANDDIST_METRICS
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/../../poker-eval/include
 LOCAL_SRC_FILES := \
+	AliasTable.cpp \
+	BoardEnumerator.cpp \
 	Card.cpp \
 	CardConverter.cpp \
+	DistributionCodec.cpp \
+	EquityJob.cpp \
+	EquityStatistics.cpp \
+	HandBitset.cpp \
+	HandCompatibility.cpp \
+	HandDistApi.cpp \
+	HandDistMetrics.cpp \
+	HandHistory.cpp \
+	HandHistoryImporter.cpp \
+	HandRanking.cpp \
 	HoldemAgnosticHand.cpp \
+	HoldemCalculator.cpp \
 	HoldemHandDistribution.cpp \
 	OmahaAgnosticHand.cpp \
+	OmahaCalculator.cpp \
 	OmahaHandDistribution.cpp \
-	mtrand.cpp
+	OrderingTables.cpp \
+	ParseError.cpp \
+	PokerTrackerReader.cpp \
+	PreflopTable.cpp \
+	RandomEngine.cpp \
+	RangeCache.cpp \
+	StratifiedSampler.cpp \
+	mtrand.cpp \
+	poker-handdist.cpp
 LOCAL_SHARED_LIBRARIES += poker-eval
 LOCAL_LDLIBS := -llog -landroid
 LOCAL_EXPORT_CPP_INCLUDES := $(LOCAL_PATH)
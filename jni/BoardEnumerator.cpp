@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <inlines/eval.h>
+#include "HandDistributions.h"
+#include "BoardEnumerator.h"
+
+BoardEnumerator::BoardEnumerator(void)
+{
+    Init(NULL, 0);
+}
+
+BoardEnumerator::BoardEnumerator(const StdDeck_CardMask* fixed, int count)
+{
+    Init(fixed, count);
+}
+
+BoardEnumerator::~BoardEnumerator(void)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Keep the suit permutations that map every fixed set onto itself. Note that
+// each set is fixed on its own: swapping hearts and spades in "AhAs|KhKs"
+// is a symmetry, but not one that swaps hero's and villain's cards.
+///////////////////////////////////////////////////////////////////////////////
+void BoardEnumerator::Init(const StdDeck_CardMask* fixed, int count)
+{
+    StdDeck_CardMask_RESET(m_used);
+    for (int i = 0; i < count; i++)
+        StdDeck_CardMask_OR(m_used, m_used, fixed[i]);
+
+    int perm[4] = { 0, 1, 2, 3 };
+    do {
+        bool symmetry = true;
+        for (int i = 0; i < count && symmetry; i++) {
+            StdDeck_CardMask permuted = PermuteSuits(fixed[i], perm);
+            symmetry = StdDeck_CardMask_EQUAL(permuted, fixed[i]);
+        }
+        if (symmetry)
+            m_perms.push_back(vector<int>(perm, perm + 4));
+    } while (std::next_permutation(perm, perm + 4));
+}
+
+StdDeck_CardMask BoardEnumerator::PermuteSuits(StdDeck_CardMask cards, const int perm[4])
+{
+    unsigned int ranks[4];
+    ranks[StdDeck_Suit_HEARTS] = StdDeck_CardMask_HEARTS(cards);
+    ranks[StdDeck_Suit_DIAMONDS] = StdDeck_CardMask_DIAMONDS(cards);
+    ranks[StdDeck_Suit_CLUBS] = StdDeck_CardMask_CLUBS(cards);
+    ranks[StdDeck_Suit_SPADES] = StdDeck_CardMask_SPADES(cards);
+
+    unsigned int permuted[4];
+    for (int suit = 0; suit < 4; suit++)
+        permuted[perm[suit]] = ranks[suit];
+
+    StdDeck_CardMask result;
+    StdDeck_CardMask_RESET(result);
+    StdDeck_CardMask_SET_HEARTS(result, permuted[StdDeck_Suit_HEARTS]);
+    StdDeck_CardMask_SET_DIAMONDS(result, permuted[StdDeck_Suit_DIAMONDS]);
+    StdDeck_CardMask_SET_CLUBS(result, permuted[StdDeck_Suit_CLUBS]);
+    StdDeck_CardMask_SET_SPADES(result, permuted[StdDeck_Suit_SPADES]);
+    return result;
+}
+
+int BoardEnumerator::Flops(vector<StdDeck_CardMask>& boards, vector<int>& weights) const
+{
+    StdDeck_CardMask empty;
+    StdDeck_CardMask_RESET(empty);
+    return Enumerate(empty, 3, boards, weights);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Only the symmetries that also leave the partial board in place apply. A set
+// of new cards is canonical when no symmetry maps it to a smaller mask, and
+// its class has one member per distinct image.
+///////////////////////////////////////////////////////////////////////////////
+int BoardEnumerator::Enumerate(StdDeck_CardMask board, int count, vector<StdDeck_CardMask>& boards, vector<int>& weights) const
+{
+    vector<const int*> perms;
+    for (size_t p = 0; p < m_perms.size(); p++) {
+        StdDeck_CardMask permuted = PermuteSuits(board, &m_perms[p][0]);
+        if (StdDeck_CardMask_EQUAL(permuted, board))
+            perms.push_back(&m_perms[p][0]);
+    }
+
+    StdDeck_CardMask used, none;
+    StdDeck_CardMask_OR(used, m_used, board);
+    StdDeck_CardMask_RESET(none);
+
+    size_t before = boards.size();
+    Deal(count, 0, used, board, none, perms, boards, weights);
+    return boards.size() - before;
+}
+
+void BoardEnumerator::Deal(int count, int firstCard, StdDeck_CardMask used, StdDeck_CardMask board, StdDeck_CardMask cards,
+    const vector<const int*>& perms, vector<StdDeck_CardMask>& boards, vector<int>& weights) const
+{
+    if (count == 0) {
+        uint64_t images[24];
+        size_t imageCount = perms.size();
+        for (size_t p = 0; p < imageCount; p++) {
+            StdDeck_CardMask image = PermuteSuits(cards, perms[p]);
+            if (image.cards_n < cards.cards_n)
+                return;
+            images[p] = image.cards_n;
+        }
+
+        std::sort(images, images + imageCount);
+        StdDeck_CardMask full;
+        StdDeck_CardMask_OR(full, board, cards);
+        boards.push_back(full);
+        weights.push_back(std::unique(images, images + imageCount) - images);
+        return;
+    }
+
+    for (int card = firstCard; card <= StdDeck_N_CARDS - count; card++) {
+        if (StdDeck_CardMask_CARD_IS_SET(used, card))
+            continue;
+        StdDeck_CardMask next = cards;
+        StdDeck_CardMask_SET(next, card);
+        Deal(count - 1, card + 1, used, board, next, perms, boards, weights);
+    }
+}
@@ -0,0 +1,66 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Enumerates the boards (or the cards completing a partial board) that can
+// still be dealt, one board per suit isomorphism class together with the
+// number of boards in its class.
+//
+// Two boards are in the same class when a permutation of the suits maps one
+// onto the other while leaving each of the fixed card sets given to the
+// constructor (hero's hand, villain's hand, dead cards...) and the partial
+// board in place. With nothing fixed, the 22,100 flops fall into 1,755
+// classes; fixing the players' hole cards of either game leaves fewer
+// symmetries, and specific suits in every set leave none.
+//
+//		BoardEnumerator enumerator(fixed, 2);
+//		enumerator.Enumerate(flop, 1, turns, weights);	// canonical turns
+///////////////////////////////////////////////////////////////////////////////
+class BoardEnumerator
+{
+public:
+	BoardEnumerator();
+	BoardEnumerator(const StdDeck_CardMask* fixed, int count);
+	~BoardEnumerator();
+
+	// Append every canonical board made of board plus count more live cards
+	// and the size of its class. Returns the number of boards appended.
+	int Enumerate(StdDeck_CardMask board, int count, vector<StdDeck_CardMask>& boards, vector<int>& weights) const;
+
+	// Canonical flops: Enumerate() from an empty board.
+	int Flops(vector<StdDeck_CardMask>& boards, vector<int>& weights) const;
+
+	// Number of suit permutations that leave the fixed sets in place.
+	int GetSymmetryCount() const { return m_perms.size(); }
+
+	// Map the cards of suit s to suit perm[s].
+	static StdDeck_CardMask PermuteSuits(StdDeck_CardMask cards, const int perm[4]);
+
+private:
+	void Init(const StdDeck_CardMask* fixed, int count);
+	void Deal(int count, int firstCard, StdDeck_CardMask used, StdDeck_CardMask board, StdDeck_CardMask cards,
+		const vector<const int*>& perms, vector<StdDeck_CardMask>& boards, vector<int>& weights) const;
+
+	StdDeck_CardMask m_used;	// union of the fixed sets
+	vector< vector<int> > m_perms;
+};
@@ -23,6 +23,48 @@
 const char* Card::m_rankChars = "23456789TJQKA";
 const char* Card::m_suitChars = "hdcs";
 
+// Rank of each character ('X', any rank, reads as a deuce), or -1
+const int8_t Card::m_charRanks[256] =
+{
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1,  0,  1,  2,  3,  4,  5,  6,  7, -1, -1, -1, -1, -1, -1,
+	-1, 12, -1, -1, -1, -1, -1, -1, -1, -1,  9, 11, -1, -1, -1, -1,
+	-1, 10, -1, -1,  8, -1, -1, -1,  0, -1, -1, -1, -1, -1, -1, -1,
+	-1, 12, -1, -1, -1, -1, -1, -1, -1, -1,  9, 11, -1, -1, -1, -1,
+	-1, 10, -1, -1,  8, -1, -1, -1,  0, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+// Suit of each character, or -1
+const int8_t Card::m_charSuits[256] =
+{
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1,  2,  1, -1, -1, -1,  0, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1,  2,  1, -1, -1, -1,  0, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
 Card::Card(void)
 {
 }
@@ -33,39 +75,22 @@ Card::~Card(void)
 
 int Card::CharToRank(const char c)
 {
-	switch (c)
-	{
-	case 'A': case 'a':	return 12;
-	case 'K': case 'k':	return 11;
-	case 'Q': case 'q':	return 10;
-	case 'J': case 'j':     return 9;
-	case 'T': case 't':     return 8;
-	case '9':	        return 7;
-	case '8':	        return 6;
-	case '7':	        return 5;
-	case '6':	        return 4;
-	case '5':	        return 3;
-	case '4':	        return 2;
-	case '3':	        return 1;
-	case '2':	        return 0;
-        case 'X': case 'x':     return 0;
-	};
-
-	return -1;
+	return m_charRanks[(uint8_t)c];
 }
 
 
 int Card::CharToSuit(const char s)
 {
-	switch (s)
-	{
-	case 'S': case 's':	return 3;
-	case 'C': case 'c':	return 2;
-	case 'D': case 'd':	return 1;
-	case 'H': case 'h':	return 0;
-	};
+	return m_charSuits[(uint8_t)s];
+}
 
-	return -1;
+int Card::TextToCard(const char* text)
+{
+	int rank = m_charRanks[(uint8_t)text[0]];
+	if (rank < 0 || text[0] == 'X' || text[0] == 'x')
+		return -1;
+	int suit = m_charSuits[(uint8_t)text[1]];
+	return suit < 0 ? -1 : 13 * suit + rank;
 }
 
 char Card::RankToChar(int rank)
@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <stdint.h>
+
 class Card
 {
 public:
@@ -58,7 +60,14 @@ public:
 	static char RankToChar(int rank);
 	static char SuitToChar(int suit);
 
+	// Card number (13 * suit + rank, poker-eval's numbering) of the two
+	// characters at text, such as "Ah", or -1 if they aren't a card. The
+	// second character is only read if the first is a rank.
+	static int TextToCard(const char* text);
+
 private:
 	static const char* m_rankChars;
 	static const char* m_suitChars;
+	static const int8_t m_charRanks[256];
+	static const int8_t m_charSuits[256];
 };
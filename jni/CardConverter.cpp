@@ -21,6 +21,7 @@
 #include <inlines/eval.h>
 #include "HandDistributions.h"
 #include "CardConverter.h"
+#include "Card.h"
 
 StdDeck_CardMask CardConverter::PokerEvalCards[53] = 
 { 
@@ -82,3 +83,111 @@ StdDeck_CardMask CardConverter::PokerEvalCards[53] =
     StdDeck_MASK(StdDeck_MAKE_CARD(StdDeck_Rank_ACE, StdDeck_Suit_SPADES))
 };
 
+
+// PokerTracker ids in PokerEvalToBits() form: 2c..Ac, 2d..Ad, 2h..Ah, 2s..As
+#define PT_SUIT(suit) \
+    (uint64_t)1 << (13 * (suit) + 0), (uint64_t)1 << (13 * (suit) + 1), (uint64_t)1 << (13 * (suit) + 2), \
+    (uint64_t)1 << (13 * (suit) + 3), (uint64_t)1 << (13 * (suit) + 4), (uint64_t)1 << (13 * (suit) + 5), \
+    (uint64_t)1 << (13 * (suit) + 6), (uint64_t)1 << (13 * (suit) + 7), (uint64_t)1 << (13 * (suit) + 8), \
+    (uint64_t)1 << (13 * (suit) + 9), (uint64_t)1 << (13 * (suit) + 10), (uint64_t)1 << (13 * (suit) + 11), \
+    (uint64_t)1 << (13 * (suit) + 12)
+
+const uint64_t CardConverter::PokerTrackerBits[53] =
+{
+    0,
+    PT_SUIT(StdDeck_Suit_CLUBS),
+    PT_SUIT(StdDeck_Suit_DIAMONDS),
+    PT_SUIT(StdDeck_Suit_HEARTS),
+    PT_SUIT(StdDeck_Suit_SPADES)
+};
+
+#undef PT_SUIT
+
+///////////////////////////////////////////////////////////////////////////////
+// One table lookup and OR per card. A card that adds nothing to the row
+// (unknown, out of range or repeated) leaves it short of cardsPerRow.
+///////////////////////////////////////////////////////////////////////////////
+size_t CardConverter::PokerTrackerToBits(const int* pIds, int cardsPerRow, size_t rows, uint64_t* pHands)
+{
+    size_t converted = 0;
+    for (size_t row = 0; row < rows; row++, pIds += cardsPerRow) {
+        uint64_t hand = 0;
+        int cards = 0;
+        for (int i = 0; i < cardsPerRow; i++) {
+            unsigned int id = (unsigned int)pIds[i];
+            uint64_t card = id < 53 ? PokerTrackerBits[id] : 0;
+            cards += (card & ~hand) != 0;
+            hand |= card;
+        }
+        bool valid = (cards == cardsPerRow);
+        pHands[row] = valid ? hand : 0;
+        converted += valid;
+    }
+    return converted;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Every card is two lookups in Card's character tables. theHand holds the
+// cards read before an error too, which is what the unchecked overload
+// returns.
+///////////////////////////////////////////////////////////////////////////////
+int CardConverter::TextToPokerEval(const char* strHand, StdDeck_CardMask& theHand)
+{
+    StdDeck_CardMask_RESET(theHand);
+    if (strHand == NULL)
+        return 0;
+
+    int numCards = 0;
+    for (const char* p = strHand; *p != '\0'; ) {
+        if (*p == ' ') {
+            p++;
+            continue;
+        }
+        int card = Card::TextToCard(p);
+        if (card < 0 || StdDeck_CardMask_CARD_IS_SET(theHand, card))
+            return -1;
+        StdDeck_CardMask_SET(theHand, card);
+        numCards++;
+        p += 2;
+    }
+    return numCards;
+}
+
+size_t CardConverter::TextToPokerEval(const char* const* pHands, size_t count, StdDeck_CardMask* pMasks)
+{
+    size_t decoded = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (TextToPokerEval(pHands[i], pMasks[i]) < 0)
+            StdDeck_CardMask_RESET(pMasks[i]);
+        else
+            decoded++;
+    }
+    return decoded;
+}
+
+int CardConverter::TextToPokerEvalArray(const char* strHand, StdDeck_CardMask* pArray)
+{
+    int numCards = 0;
+    StdDeck_CardMask mask;
+    StdDeck_CardMask_RESET(mask);
+    if (strHand != NULL && pArray != NULL)
+    {
+        int arrayIndex = 0;
+        for (const char* pChar = strHand; *pChar != '\0'; pChar += 2, numCards++)
+        {
+            int cardIndex = Card::TextToCard(pChar);
+            if (cardIndex < 0)
+                break;
+            StdDeck_CardMask_SET(mask, cardIndex);
+
+            // Store the mask of every second card
+            if (numCards % 2 != 0)
+            {
+                pArray[arrayIndex] = mask;
+                arrayIndex++;
+            }
+        }
+    }
+
+    return numCards;
+}
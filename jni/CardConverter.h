@@ -33,68 +33,65 @@ public:
 
 	//////////////////////////////////////////////////////////////////////////////
 	// Given a string such as "AcKcQcJcTc" representing a poker hand, return a 
-	// poker-eval StdDeck_CardMask representing that hand.
+	// poker-eval StdDeck_CardMask representing that hand. Decoding stops at
+	// the first pair of characters that isn't a card.
 	//////////////////////////////////////////////////////////////////////////////
 	static StdDeck_CardMask TextToPokerEval(const char* strHand)
 	{
-		StdDeck_CardMask theHand, theCard;
-		StdDeck_CardMask_RESET(theHand);
-
-		if (strHand && strlen(strHand))
-		{
-			int cardIndex = -1;
-			char* curCard = const_cast<char*>(strHand);
-
-			while (*curCard)
-			{
-				// Take the card text and convert it to an index (0..51)
-				StdDeck_stringToCard(curCard, &cardIndex);
-				// Convert the card index to a mask
-				theCard = StdDeck_MASK(cardIndex);
-				// Add the card (mask) to the hand
-				StdDeck_CardMask_OR(theHand, theHand, theCard);
-				// Advance to the next card (if any)
-				curCard += 2;
-			}
-		}
-
+		StdDeck_CardMask theHand;
+		TextToPokerEval(strHand, theHand);
 		return theHand;
 	}
 
 
+	//////////////////////////////////////////////////////////////////////////////
+	// Validating form of the above: decode the cards of a string such as
+	// "AhKd7c" (spaces between cards are allowed) into a mask. Returns the
+	// number of cards, or -1 if the text holds anything that isn't a card or
+	// the same card twice. A NULL or empty string is no cards.
+	//////////////////////////////////////////////////////////////////////////////
+	static int TextToPokerEval(const char* strHand, StdDeck_CardMask& theHand);
+
+
+	//////////////////////////////////////////////////////////////////////////////
+	// Decode count strings at once into pMasks, as TextToPokerEval() does.
+	// A string that isn't valid gives an empty mask. Returns the number of
+	// strings decoded without an error.
+	//////////////////////////////////////////////////////////////////////////////
+	static size_t TextToPokerEval(const char* const* pHands, size_t count, StdDeck_CardMask* pMasks);
+
+
 	//////////////////////////////////////////////////////////////////////////////
 	// Given a string such as "AcKcQcJcTc" representing a poker hand, fill an
-	// array with the PokerEval mask value of each card.
+	// array with the PokerEval mask of the cards up to every second card.
+	// Returns the number of cards read, stopping at the first that isn't one.
 	//////////////////////////////////////////////////////////////////////////////
-	static int TextToPokerEvalArray(const char* strHand, StdDeck_CardMask* pArray)
+	static int TextToPokerEvalArray(const char* strHand, StdDeck_CardMask* pArray);
+
+
+
+	//////////////////////////////////////////////////////////////////////////////
+	// Convert a mask to and from a plain 64 bit integer with bit
+	// 13 * suit + rank set for each card (poker-eval's card index), the
+	// format the JNI bridge and the C API use.
+	//////////////////////////////////////////////////////////////////////////////
+	static uint64_t PokerEvalToBits(StdDeck_CardMask mask)
+	{
+		return (uint64_t)StdDeck_CardMask_HEARTS(mask) << (13 * StdDeck_Suit_HEARTS) |
+			(uint64_t)StdDeck_CardMask_DIAMONDS(mask) << (13 * StdDeck_Suit_DIAMONDS) |
+			(uint64_t)StdDeck_CardMask_CLUBS(mask) << (13 * StdDeck_Suit_CLUBS) |
+			(uint64_t)StdDeck_CardMask_SPADES(mask) << (13 * StdDeck_Suit_SPADES);
+	}
+
+	static StdDeck_CardMask BitsToPokerEval(uint64_t bits)
 	{
-		int numCards = 0;
 		StdDeck_CardMask mask;
 		StdDeck_CardMask_RESET(mask);
-		if (strHand != NULL && pArray != NULL)
-		{
-			int cardIndex = -1;
-			int arrayIndex = 0;
-
-			for (const char* pChar = strHand; *pChar != '\0'; pChar += 2, numCards++)
-			{
-				
-				// First, take the string and convert it to a card index.
-				StdDeck_stringToCard(const_cast<char*>(pChar), &cardIndex);
-				
-				// Then take the card index and convert it to a mask
-				StdDeck_CardMask_OR(mask, mask, StdDeck_MASK(cardIndex));
-
-				// Lastly store the mask in the array
-				if (numCards % 2 != 0)
-				{
-					pArray[arrayIndex] = mask;
-					arrayIndex++;
-				}
-			}
-		}
-
-		return numCards;
+		StdDeck_CardMask_SET_HEARTS(mask, (bits >> (13 * StdDeck_Suit_HEARTS)) & 0x1fff);
+		StdDeck_CardMask_SET_DIAMONDS(mask, (bits >> (13 * StdDeck_Suit_DIAMONDS)) & 0x1fff);
+		StdDeck_CardMask_SET_CLUBS(mask, (bits >> (13 * StdDeck_Suit_CLUBS)) & 0x1fff);
+		StdDeck_CardMask_SET_SPADES(mask, (bits >> (13 * StdDeck_Suit_SPADES)) & 0x1fff);
+		return mask;
 	}
 
 
@@ -107,8 +104,18 @@ public:
 		return PokerEvalCards[nPokerTrackerCardId];
 	}
 
+
+	//////////////////////////////////////////////////////////////////////////////
+	// Convert rows of cardsPerRow PokerTracker card ids each (row after row)
+	// to masks in PokerEvalToBits() form. A row holding an unknown card (0),
+	// an id out of range or the same card twice becomes 0. Returns the number
+	// of rows converted.
+	//////////////////////////////////////////////////////////////////////////////
+	static size_t PokerTrackerToBits(const int* pIds, int cardsPerRow, size_t rows, uint64_t* pHands);
+
 private:
 	CardConverter(void) { }
 
 	static StdDeck_CardMask PokerEvalCards[53];
+	static const uint64_t PokerTrackerBits[53];
 };
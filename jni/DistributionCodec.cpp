@@ -0,0 +1,384 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <inlines/eval_omaha.h>
+#include "HandDistributions.h"
+#include "DistributionCodec.h"
+#include "HoldemHandDistribution.h"
+#include "OmahaHandDistribution.h"
+#include "HandBitset.h"
+#include "CardConverter.h"
+#include "OrderingTables.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Host order to little-endian and back: nothing to do on little-endian hosts.
+///////////////////////////////////////////////////////////////////////////////
+static uint32_t Little(uint32_t value)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return __builtin_bswap32(value);
+#else
+    return value;
+#endif
+}
+
+static uint64_t Little(uint64_t value)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return __builtin_bswap64(value);
+#else
+    return value;
+#endif
+}
+
+static void SwapHeader(DistributionHeader& header)
+{
+    header.version = Little(header.version);
+    header.holeCards = Little(header.holeCards);
+    header.count = Little(header.count);
+    header.dead = Little(header.dead);
+    header.textSize = Little(header.textSize);
+    header.handsSize = Little(header.handsSize);
+    header.weightsSize = Little(header.weightsSize);
+}
+
+// The header of an encoded distribution, in host order
+static void GetHeader(const uint8_t* data, DistributionHeader& header)
+{
+    memcpy(&header, data, sizeof(header));
+    SwapHeader(header);
+}
+
+// First byte of an encoded set
+enum { HANDS_RUNS = 0, HANDS_WORDS = 1 };
+
+static void PutVarint(vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+static bool GetVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = *p++;
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+// First bit at or after from that is set (or clear), or size if none
+static int NextBit(const uint64_t* words, int size, int from, bool set)
+{
+    while (from < size) {
+        uint64_t word = set ? words[from >> 6] : ~words[from >> 6];
+        word &= ~(uint64_t)0 << (from & 63);
+        if (word != 0)
+            return min(size, (from & ~63) + __builtin_ctzll(word));
+        from = (from & ~63) + 64;
+    }
+    return size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Runs of hands, unless they come out larger than the words themselves; a
+// range of classes is a few hundred bytes either way, and XXXX or a wide
+// percent slice is at most the 33KB of the Omaha bitset.
+///////////////////////////////////////////////////////////////////////////////
+void DistributionCodec::EncodeHands(const HandBitset& hands, vector<uint8_t>& out)
+{
+    size_t start = out.size();
+    size_t wordBytes = hands.GetWordCount() * sizeof(uint64_t);
+    const uint64_t* words = hands.GetWords();
+    int size = hands.GetSize();
+
+    out.push_back(HANDS_RUNS);
+    int end = 0;
+    for (;;) {
+        int first = NextBit(words, size, end, true);
+        if (first == size)
+            return;
+        int last = NextBit(words, size, first, false);
+        PutVarint(out, first - end);
+        PutVarint(out, last - first);
+        end = last;
+
+        if (out.size() - start > wordBytes)
+            break;
+    }
+
+    out.resize(start);
+    out.push_back(HANDS_WORDS);
+    for (int w = 0; w < hands.GetWordCount(); w++) {
+        uint64_t word = Little(words[w]);
+        out.insert(out.end(), (const uint8_t*)&word, (const uint8_t*)&word + sizeof(word));
+    }
+}
+
+bool DistributionCodec::DecodeHands(const uint8_t* data, size_t size, HandBitset& hands)
+{
+    hands.Clear();
+    if (size == 0)
+        return false;
+
+    if (data[0] == HANDS_WORDS) {
+        // Copied, as the words of a mapped file need not be aligned
+        vector<uint64_t> words(hands.GetWordCount());
+        if (size != 1 + words.size() * sizeof(uint64_t))
+            return false;
+        memcpy(words.data(), data + 1, size - 1);
+        for (size_t w = 0; w < words.size(); w++)
+            words[w] = Little(words[w]);
+        hands.SetWords(words.data());
+        return true;
+    }
+
+    if (data[0] != HANDS_RUNS)
+        return false;
+
+    const uint8_t* p = data + 1;
+    const uint8_t* end = data + size;
+    uint64_t position = 0;
+    while (p < end) {
+        uint64_t skipped, length;
+        if (!GetVarint(p, end, skipped) || !GetVarint(p, end, length) || length == 0)
+            return false;
+        position += skipped;
+        if (skipped > (uint64_t)hands.GetSize() || position + length > (uint64_t)hands.GetSize())
+            return false;
+        hands.SetRange((int)position, (int)(position + length));
+        position += length;
+    }
+    return true;
+}
+
+size_t DistributionCodec::GetEncodedSize(const uint8_t* data, size_t size, int& holeCards)
+{
+    holeCards = 0;
+    if (data == NULL || size < sizeof(DistributionHeader))
+        return 0;
+
+    DistributionHeader header;
+    GetHeader(data, header);
+    if (memcmp(header.magic, DISTRIBUTION_MAGIC, 4) != 0 ||
+        header.version != DISTRIBUTION_VERSION ||
+        (header.holeCards != 2 && header.holeCards != OMAHA_MAXHOLE) ||
+        memchr(header.ordering, '\0', sizeof(header.ordering)) == NULL)
+        return 0;
+
+    uint64_t total = (uint64_t)sizeof(header) + header.textSize + header.handsSize + header.weightsSize;
+    if (total > size)
+        return 0;
+
+    holeCards = header.holeCards;
+    return (size_t)total;
+}
+
+size_t DistributionCodec::Encode(const HoldemHandDistribution& distribution, vector<uint8_t>& out)
+{
+    return EncodeDistribution(distribution, 2, out);
+}
+
+size_t DistributionCodec::Encode(const OmahaHandDistribution& distribution, vector<uint8_t>& out)
+{
+    return EncodeDistribution(distribution, OMAHA_MAXHOLE, out);
+}
+
+bool DistributionCodec::Decode(const uint8_t* data, size_t size, HoldemHandDistribution& distribution)
+{
+    return DecodeDistribution(data, size, 2, distribution);
+}
+
+bool DistributionCodec::Decode(const uint8_t* data, size_t size, OmahaHandDistribution& distribution)
+{
+    return DecodeDistribution(data, size, OMAHA_MAXHOLE, distribution);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The header is written last, once the sizes of the sections are known.
+///////////////////////////////////////////////////////////////////////////////
+template <class Distribution>
+size_t DistributionCodec::EncodeDistribution(const Distribution& distribution, int holeCards, vector<uint8_t>& out)
+{
+    DistributionHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DISTRIBUTION_MAGIC, 4);
+    header.version = DISTRIBUTION_VERSION;
+    header.holeCards = holeCards;
+    header.count = distribution.m_hands.size();
+    if (distribution.m_aliasValid)
+        header.dead = CardConverter::PokerEvalToBits(distribution.m_aliasDead);
+    const OrderingTable* ordering = distribution.m_pOrdering;
+    if (ordering != NULL && strlen(ordering->GetName()) < sizeof(header.ordering))
+        strcpy(header.ordering, ordering->GetName());
+
+    size_t start = out.size();
+    out.resize(start + sizeof(header));
+
+    const string& text = distribution.m_handText;
+    out.insert(out.end(), text.begin(), text.end());
+    header.textSize = text.size();
+
+    HandBitset hands(holeCards);
+    hands.Set(distribution.m_hands);
+    size_t handsStart = out.size();
+    EncodeHands(hands, out);
+    header.handsSize = out.size() - handsStart;
+
+    if (!distribution.m_weights.empty()) {
+        // Weights follow the hands in index order, the order they decode in
+        vector<pair<int, double> > weights(distribution.m_hands.size());
+        for (size_t i = 0; i < weights.size(); i++)
+            weights[i] = make_pair(HandBitset::Index(distribution.m_hands[i], holeCards), distribution.m_weights[i]);
+        sort(weights.begin(), weights.end());
+
+        size_t weightsStart = out.size();
+        for (size_t i = 0; i < weights.size(); ) {
+            size_t j = i + 1;
+            while (j < weights.size() && weights[j].second == weights[i].second)
+                j++;
+            PutVarint(out, j - i);
+            uint64_t bits;
+            memcpy(&bits, &weights[i].second, sizeof(bits));
+            bits = Little(bits);
+            out.insert(out.end(), (const uint8_t*)&bits, (const uint8_t*)&bits + sizeof(bits));
+            i = j;
+        }
+        header.weightsSize = out.size() - weightsStart;
+    }
+
+    SwapHeader(header);
+    memcpy(&out[start], &header, sizeof(header));
+    return out.size() - start;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Everything is checked before the distribution is touched. The hands come
+// out of the bitset in index order and are put back in the order Init()
+// leaves them in.
+///////////////////////////////////////////////////////////////////////////////
+template <class Distribution>
+bool DistributionCodec::DecodeDistribution(const uint8_t* data, size_t size, int holeCards, Distribution& distribution)
+{
+    int encodedCards;
+    if (GetEncodedSize(data, size, encodedCards) == 0 || encodedCards != holeCards)
+        return false;
+
+    DistributionHeader header;
+    GetHeader(data, header);
+    const char* text = (const char*)data + sizeof(header);
+    const uint8_t* handBytes = data + sizeof(header) + header.textSize;
+    const uint8_t* weightBytes = handBytes + header.handsSize;
+
+    HandBitset set(holeCards);
+    if (!DecodeHands(handBytes, header.handsSize, set) || set.Count() != (int)header.count)
+        return false;
+
+    // Only the hands in the set are visited, not every combination. Hand
+    // indices are colex ranks, so the next index's hand is the next larger
+    // integer with as many bits set, and only a jump has to be unranked.
+    vector<uint64_t> masks;
+    masks.reserve(header.count);
+    const uint64_t* words = set.GetWords();
+    int previous = -2;
+    uint64_t bits = 0;
+    for (int w = 0; w < set.GetWordCount(); w++) {
+        for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+            int index = w * 64 + __builtin_ctzll(word);
+            if (index == previous + 1) {
+                uint64_t low = bits & (0 - bits);
+                uint64_t ripple = bits + low;
+                bits = ripple | (((bits ^ ripple) >> 2) / low);
+            }
+            else
+                bits = HandBitset::BitsOfIndex(index, holeCards);
+            previous = index;
+            masks.push_back(CardConverter::BitsToPokerEval(bits).cards_n);
+        }
+    }
+
+    vector<double> weights;
+    if (header.weightsSize > 0) {
+        const uint8_t* p = weightBytes;
+        const uint8_t* end = weightBytes + header.weightsSize;
+        while (p < end) {
+            uint64_t length, bits;
+            double weight;
+            if (!GetVarint(p, end, length) || length == 0 || length > masks.size() - weights.size() ||
+                end - p < (ptrdiff_t)sizeof(double))
+                return false;
+            memcpy(&bits, p, sizeof(bits));
+            bits = Little(bits);
+            memcpy(&weight, &bits, sizeof(weight));
+            p += sizeof(double);
+            if (!(weight > 0.0) || std::isinf(weight))
+                return false;
+            weights.insert(weights.end(), length, weight);
+        }
+        if (weights.size() != masks.size())
+            return false;
+    }
+
+    // Weights of 1 everywhere are left out, as Init() does
+    bool uniform = true;
+    for (size_t i = 0; i < weights.size() && uniform; i++)
+        uniform = (weights[i] == 1.0);
+
+    // The same order as CardMaskGreaterThan, on the plain integers
+    vector<StdDeck_CardMask> hands(masks.size());
+    if (uniform) {
+        sort(masks.begin(), masks.end());
+        for (size_t i = 0; i < masks.size(); i++)
+            hands[i].cards_n = masks[i];
+        weights.clear();
+    }
+    else {
+        vector<pair<uint64_t, double> > weighted(masks.size());
+        for (size_t i = 0; i < masks.size(); i++)
+            weighted[i] = make_pair(masks[i], weights[i]);
+        sort(weighted.begin(), weighted.end());
+        for (size_t i = 0; i < masks.size(); i++) {
+            hands[i].cards_n = weighted[i].first;
+            weights[i] = weighted[i].second;
+        }
+    }
+
+    distribution.m_hands.swap(hands);
+    distribution.m_weights.swap(weights);
+
+    distribution.m_handText.assign(text, header.textSize);
+    distribution.m_pOrdering = header.ordering[0] != '\0' ? OrderingTables::Find(header.ordering) : NULL;
+    distribution.m_error.Clear();
+
+    distribution.m_aliasValid = false;
+    distribution.SetDeadCards(CardConverter::BitsToPokerEval(header.dead));
+    if (distribution.m_hands.size() == 1)
+        distribution.m_current = distribution.m_hands[0];
+
+    return true;
+}
@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+class HoldemHandDistribution;
+class OmahaHandDistribution;
+class HandBitset;
+
+///////////////////////////////////////////////////////////////////////////////
+// Compact binary form of an instantiated distribution, to ship it to another
+// process or keep it on disk instead of parsing its range text again. It
+// holds the hands, their weights, the dead cards and the name of the
+// ordering table, so the decoded distribution is the one that was encoded,
+// down to the order of its hands (and so the hands a seeded Choose() draws).
+//
+//		vector<uint8_t> bytes;
+//		DistributionCodec::Encode(distribution, bytes);
+//		...
+//		OmahaHandDistribution copy;
+//		DistributionCodec::Decode(bytes.data(), bytes.size(), copy);
+//
+// The hands are stored as a HandBitset: as the runs of consecutive hand
+// indices, or as the raw words when those are smaller (wide Omaha ranges).
+///////////////////////////////////////////////////////////////////////////////
+class DistributionCodec
+{
+public:
+	// Append the encoded distribution to out. Returns the number of bytes
+	// appended.
+	static size_t Encode(const HoldemHandDistribution& distribution, vector<uint8_t>& out);
+	static size_t Encode(const OmahaHandDistribution& distribution, vector<uint8_t>& out);
+
+	// Replace the distribution with the one encoded in data. Returns false,
+	// leaving the distribution alone, if data is malformed or holds a
+	// distribution of the other game.
+	static bool Decode(const uint8_t* data, size_t size, HoldemHandDistribution& distribution);
+	static bool Decode(const uint8_t* data, size_t size, OmahaHandDistribution& distribution);
+
+	// Size of the distribution encoded at the start of data, and its hole
+	// cards (2 or 4); 0 if data doesn't start with one. Decode() reads no
+	// further, so encoded distributions can be stored back to back.
+	static size_t GetEncodedSize(const uint8_t* data, size_t size, int& holeCards);
+
+	// The set alone, in the form used above
+	static void EncodeHands(const HandBitset& hands, vector<uint8_t>& out);
+	static bool DecodeHands(const uint8_t* data, size_t size, HandBitset& hands);
+
+private:
+	DistributionCodec(void) { }
+
+	template <class Distribution>
+	static size_t EncodeDistribution(const Distribution& distribution, int holeCards, vector<uint8_t>& out);
+	template <class Distribution>
+	static bool DecodeDistribution(const uint8_t* data, size_t size, int holeCards, Distribution& distribution);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Encoded distribution layout. All integers, the bitset's words and the
+// weights (IEEE doubles) are little-endian whatever the host's byte order,
+// so an encoded distribution can go to a process on any machine.
+//
+//		DistributionHeader
+//		char text[textSize]				(the range text, without a NUL)
+//		uint8_t hands[handsSize]		(EncodeHands())
+//		uint8_t weights[weightsSize]	(runs of equal weights in hand index
+//										 order: varint length, double weight;
+//										 empty when every weight is 1)
+//
+// EncodeHands() writes a kind byte, then either the varint pairs (zeros
+// skipped, hands set) of each run, or the bitset's words.
+///////////////////////////////////////////////////////////////////////////////
+#define DISTRIBUTION_MAGIC		"PHDS"
+#define DISTRIBUTION_VERSION	1
+
+struct DistributionHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t holeCards;
+	uint32_t count;			// hands
+	uint64_t dead;			// CardConverter::PokerEvalToBits() form
+	uint32_t textSize;
+	uint32_t handsSize;
+	uint32_t weightsSize;
+	uint32_t reserved;
+	char ordering[16];		// ordering table name, "" for the default
+};
@@ -0,0 +1,390 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <inlines/eval_omaha.h>
+#include "HandDistributions.h"
+#include "EquityJob.h"
+#include "EquityStatistics.h"
+#include "HoldemCalculator.h"
+#include "OmahaCalculator.h"
+#include "CardConverter.h"
+#include "RandomEngine.h"
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+// Smallest number of trials handed to a worker at once
+static const int64_t MIN_CHUNK = 1024;
+
+EquityJob::EquityJob(Game game)
+    : m_game(game), m_pOrdering(NULL), m_targetError(0.0), m_timeLimit(0), m_engine(RandomEngine::Philox), m_seed(0), m_stratified(false), m_bigCoresOnly(true), m_jobSeed(0), m_callback(NULL), m_context(NULL),
+    m_interval(100), m_playerCount(0), m_pStats(NULL), m_jobTimeLimit(0), m_remaining(0), m_nextTrial(0), m_lastNotify(0), m_cancel(false), m_running(0)
+{
+    StdDeck_CardMask_RESET(m_board);
+    StdDeck_CardMask_RESET(m_dead);
+}
+
+EquityJob::~EquityJob(void)
+{
+    Cancel();
+    Wait();
+
+    for (size_t i = 0; i < m_holdem.size(); i++)
+        delete m_holdem[i];
+    for (size_t i = 0; i < m_omaha.size(); i++)
+        delete m_omaha[i];
+    delete m_pStats;
+}
+
+void EquityJob::SetCallback(ProgressCallback callback, void* context, int64_t interval)
+{
+    m_callback = callback;
+    m_context = context;
+    m_interval = interval > 0 ? interval : 100;
+}
+
+void EquityJob::Cancel(void)
+{
+    m_cancel = true;
+}
+
+void EquityJob::Wait(void)
+{
+    for (size_t i = 0; i < m_threads.size(); i++)
+        m_threads[i].join();
+    m_threads.clear();
+}
+
+int EquityJob::GetPlayerCount(void) const
+{
+    lock_guard<mutex> lock(m_lock);
+    return m_playerCount;
+}
+
+int64_t EquityJob::GetResults(double* results, double* errors) const
+{
+    lock_guard<mutex> lock(m_lock);
+    if (m_pStats == NULL)
+        return 0;
+
+    for (int player = 0; player < m_playerCount; player++) {
+        results[player] = m_pStats->GetMean(player);
+        if (errors != NULL)
+            errors[player] = m_pStats->GetStandardError(player);
+    }
+    return m_pStats->GetCount();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Run one chunk on the worker's own calculator. Returns the number of
+// players (0 on error) and sets trials to the number of trials counted and
+// iterations to the number of trial numbers used, collisions included.
+///////////////////////////////////////////////////////////////////////////////
+int EquityJob::Calculate(int worker, int64_t firstTrial, int64_t numberOfTrials, int64_t timeLimit,
+    double* results, double* errors, int64_t& trials, int64_t& iterations)
+{
+    int players = 0;
+    if (m_game == Holdem) {
+        HoldemCalculator* pCalc = m_holdem[worker];
+        pCalc->SetOrdering(m_pOrdering);
+        pCalc->SetTimeLimit(timeLimit);
+        pCalc->SetCancel(&m_cancel);
+        pCalc->SetEngine(m_engine);
+        pCalc->SetSeed(m_jobSeed);
+        pCalc->SetStratified(m_stratified);
+        pCalc->SetFirstTrial(firstTrial);
+        players = pCalc->Calculate(m_hands.c_str(), m_board, m_dead, numberOfTrials, results);
+        trials = pCalc->GetTrials();
+        iterations = trials + pCalc->GetCollisions();
+        for (int player = 0; player < players; player++)
+            errors[player] = pCalc->GetStandardError(player);
+    }
+    else {
+        OmahaCalculator* pCalc = m_omaha[worker];
+        pCalc->SetOrdering(m_pOrdering);
+        pCalc->SetHiLo(m_game == OmahaHiLo);
+        pCalc->SetTimeLimit(timeLimit);
+        pCalc->SetCancel(&m_cancel);
+        pCalc->SetEngine(m_engine);
+        pCalc->SetSeed(m_jobSeed);
+        pCalc->SetStratified(m_stratified);
+        pCalc->SetFirstTrial(firstTrial);
+        players = pCalc->Calculate(m_hands.c_str(), m_board, m_dead, numberOfTrials, results);
+        trials = pCalc->GetTrials();
+        iterations = trials + pCalc->GetCollisions();
+        for (int player = 0; player < players; player++)
+            errors[player] = pCalc->GetStandardError(player);
+    }
+    return players;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Parse the ranges on the first worker's calculator (a run of no trials) so
+// bad input is reported here rather than by the workers, then start them.
+// The time limit counts from here, so the parse is part of it.
+///////////////////////////////////////////////////////////////////////////////
+int EquityJob::Start(const char* hands, const char* board, const char* dead, int64_t numberOfTrials, int threads)
+{
+    return Launch(hands, board, dead, numberOfTrials, m_timeLimit, threads);
+}
+
+int EquityJob::Launch(const char* hands, const char* board, const char* dead, int64_t numberOfTrials, int64_t timeLimit, int threads)
+{
+    Cancel();
+    Wait();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    if (threads < 1)
+        threads = 1;
+    while (m_holdem.size() < (size_t)threads) {
+        m_holdem.push_back(m_game == Holdem ? new HoldemCalculator() : NULL);
+        m_omaha.push_back(m_game == Holdem ? NULL : new OmahaCalculator());
+    }
+
+    m_hands = hands ? hands : "";
+    m_board = CardConverter::TextToPokerEval(board);
+    m_dead = CardConverter::TextToPokerEval(dead);
+    m_cancel = false;
+    m_jobSeed = m_seed ? m_seed : RandomEngine::NewSeed();
+
+    size_t ranges = std::count(m_hands.begin(), m_hands.end(), '|') + 1;
+    vector<double> results(ranges), errors(ranges);
+    int64_t trials = 0, iterations = 0;
+    int players = Calculate(0, 0, 0, 0, &results[0], &errors[0], trials, iterations);
+
+    // The workers of the last job are gone, but GetResults() and
+    // GetPlayerCount() may be called from other threads at any time
+    {
+        lock_guard<mutex> lock(m_lock);
+        m_playerCount = players;
+        delete m_pStats;
+        int64_t parse = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        m_jobTimeLimit = timeLimit > 0 ? max((int64_t)1, timeLimit - parse) : 0;
+        m_pStats = new EquityStatistics(players, m_targetError, m_jobTimeLimit);
+        m_remaining = numberOfTrials;
+        m_nextTrial = 0;
+        m_returned.clear();
+        m_lastNotify = 0;
+    }
+
+    if (players == 0)
+        return 0;
+
+    // A table lookup answers without running any trials
+    if (trials > 0) {
+        {
+            lock_guard<mutex> lock(m_lock);
+            m_pStats->Merge(trials, &results[0], &errors[0]);
+            m_remaining = 0;
+        }
+        Notify(true);
+        return players;
+    }
+
+    // A worker that can't be started cancels the job, so the ones that did
+    // start stop and are joined before the error goes back to the caller
+    m_threads.reserve(threads);
+    m_running = threads;
+    for (int worker = 0; worker < threads; worker++) {
+        try {
+            m_threads.push_back(thread(&EquityJob::Run, this, worker, threads));
+        }
+        catch (...) {
+            m_running -= threads - worker;
+            Cancel();
+            Wait();
+            throw;
+        }
+    }
+
+    return players;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// A job with a time limit and no trial limit, waited for. The trial count
+// only has to outlast the budget and leave room for the trial numbers.
+///////////////////////////////////////////////////////////////////////////////
+int EquityJob::Estimate(const char* hands, const char* board, const char* dead, int64_t budget, int maxThreads,
+    double* results, double* errors, int64_t& trials)
+{
+    trials = 0;
+    if (budget <= 0)
+        return 0;
+
+    if (maxThreads < 1)
+        maxThreads = GetDefaultThreads();
+
+    int players = Launch(hands, board, dead, (int64_t)1 << 62, budget, maxThreads);
+    Wait();
+
+    if (players > 0)
+        trials = GetResults(results, errors);
+    return players;
+}
+
+int EquityJob::GetDefaultThreads()
+{
+    int threads = (int)GetBigCores().size();
+    if (threads == 0)
+        threads = (int)thread::hardware_concurrency();
+    return max(1, threads);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Big cores are told apart by cpuinfo_max_freq: on big.LITTLE (and
+// prime/big/LITTLE) devices the LITTLE cluster has the lowest maximum.
+///////////////////////////////////////////////////////////////////////////////
+const vector<int>& EquityJob::GetBigCores()
+{
+    static const vector<int> bigCores = []() -> vector<int> {
+        vector<int> cores;
+#ifdef __linux__
+        int count = (int)sysconf(_SC_NPROCESSORS_CONF);
+        vector<pair<int, long> > rates;
+        for (int cpu = 0; cpu < count; cpu++) {
+            char path[96];
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+            FILE* fp = fopen(path, "r");
+            if (fp == NULL)
+                continue;
+            long rate = 0;
+            if (fscanf(fp, "%ld", &rate) != 1)
+                rate = 0;
+            fclose(fp);
+            // Offline or unlisted CPUs have no readable cpufreq; leave them
+            // out rather than giving up on the rest.
+            if (rate > 0)
+                rates.push_back(make_pair(cpu, rate));
+        }
+
+        long lowest = 0;
+        for (size_t i = 0; i < rates.size(); i++) {
+            if (i == 0 || rates[i].second < lowest)
+                lowest = rates[i].second;
+        }
+        for (size_t i = 0; i < rates.size(); i++) {
+            if (rates[i].second > lowest)
+                cores.push_back(rates[i].first);
+        }
+#endif
+        return cores;
+    }();
+
+    return bigCores;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Worker loop. Each chunk takes a share of the trials that are left, so the
+// workers finish at about the same time, and is cut short after one progress
+// interval (or whatever is left of the job's time limit). Trials a chunk
+// didn't run are handed back. With a target error, chunks are kept to about
+// the number of trials the target still needs so the job doesn't overshoot.
+///////////////////////////////////////////////////////////////////////////////
+void EquityJob::Run(int worker, int threads)
+{
+    int playerCount = GetPlayerCount();
+    vector<double> results(playerCount), errors(playerCount);
+
+#ifdef __linux__
+    const vector<int>& bigCores = GetBigCores();
+    if (m_bigCoresOnly && !bigCores.empty() && (size_t)threads <= bigCores.size()) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (size_t i = 0; i < bigCores.size(); i++)
+            CPU_SET(bigCores[i], &cpus);
+        sched_setaffinity(0, sizeof(cpus), &cpus);
+    }
+#endif
+
+    while (!m_cancel) {
+        int64_t first, chunk, timeLimit = m_interval;
+        {
+            lock_guard<mutex> lock(m_lock);
+            if (m_remaining <= 0 || m_pStats->IsDone())
+                break;
+            chunk = min(m_remaining, max(MIN_CHUNK, m_remaining / (threads * 8)));
+            if (m_targetError > 0.0 && m_pStats->GetCount() < EquityStatistics::MIN_TRIALS) {
+                chunk = min(chunk, MIN_CHUNK);
+            }
+            else if (m_targetError > 0.0) {
+                // The error falls with the square root of the trials
+                double ratio = m_pStats->GetMaxStandardError() / m_targetError;
+                int64_t needed = (int64_t)(m_pStats->GetCount() * (ratio * ratio - 1.0)) + 1;
+                chunk = min(chunk, max(MIN_CHUNK, needed / threads));
+            }
+
+            // Trial numbers handed back by cut short chunks go out first
+            if (!m_returned.empty()) {
+                pair<int64_t, int64_t>& range = m_returned.back();
+                first = range.first;
+                chunk = min(chunk, range.second);
+                range.first += chunk;
+                range.second -= chunk;
+                if (range.second == 0)
+                    m_returned.pop_back();
+            }
+            else {
+                first = m_nextTrial;
+                m_nextTrial += chunk;
+            }
+            m_remaining -= chunk;
+            if (m_jobTimeLimit > 0)
+                timeLimit = min(timeLimit, max((int64_t)1, m_jobTimeLimit - m_pStats->GetElapsed()));
+        }
+
+        int64_t trials = 0, iterations = 0;
+        int players = Calculate(worker, first, chunk, timeLimit, &results[0], &errors[0], trials, iterations);
+
+        {
+            lock_guard<mutex> lock(m_lock);
+            m_remaining += chunk - iterations;
+            if (iterations < chunk)
+                m_returned.push_back(make_pair(first + iterations, chunk - iterations));
+            if (players == playerCount)
+                m_pStats->Merge(trials, &results[0], &errors[0]);
+        }
+        Notify(false);
+    }
+
+    if (--m_running == 0)
+        Notify(true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Make the progress callback if one is due (or always, for the last one).
+///////////////////////////////////////////////////////////////////////////////
+void EquityJob::Notify(bool always)
+{
+    if (m_callback == NULL)
+        return;
+
+    lock_guard<mutex> callbackLock(m_callbackLock);
+    {
+        lock_guard<mutex> lock(m_lock);
+        int64_t now = m_pStats->GetElapsed();
+        if (!always && now - m_lastNotify < m_interval)
+            return;
+        m_lastNotify = now;
+    }
+    m_callback(this, m_context);
+}
@@ -0,0 +1,165 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <thread>
+
+class HoldemCalculator;
+class OmahaCalculator;
+class OrderingTable;
+class EquityStatistics;
+
+///////////////////////////////////////////////////////////////////////////////
+// Equity simulation run in the background on a number of worker threads. The
+// job object is the handle: Start() returns at once, GetResults() gives the
+// equities so far at any time, and Cancel() stops every worker within one
+// EquityStatistics::CHECK_INTERVAL of trials.
+//
+//		EquityJob job(EquityJob::Omaha);
+//		job.SetCallback(OnProgress, context, 250);
+//		job.Start("[AK][AK]|QQxx/ds|XXXX", "", "", 10000000, 4);
+//		...
+//		job.Cancel();		// inputs changed: throw the run away
+//
+// Workers run the simulation in chunks of at most one progress interval
+// and merge each chunk into the job's statistics, so the partial results,
+// the standard errors and the stopping rules (target error, time limit,
+// numberOfTrials) cover the whole job. Every worker keeps its calculator
+// between jobs, so a new job on the same ranges doesn't rebuild them.
+//
+// Chunks are ranges of trial numbers and trial i always deals from stream i
+// of the job's seed, so a job run to numberOfTrials with a given
+// seed runs the same trials however many threads it has; only the order in
+// which the chunks are merged (and so the last bits of the results) varies.
+///////////////////////////////////////////////////////////////////////////////
+class EquityJob
+{
+public:
+	enum Game
+	{
+		Holdem,
+		Omaha,
+		OmahaHiLo
+	};
+
+	// Called from a worker thread about once per progress interval, and once
+	// more when the job has finished or was cancelled (IsRunning() is then
+	// false). Calls are serialized. The callback may read the results or
+	// Cancel() the job, but must not Start() it, Wait() for it or delete it.
+	typedef void (*ProgressCallback)(EquityJob* job, void* context);
+
+	EquityJob(Game game);
+	virtual ~EquityJob(void);
+
+	// Settings for the next Start(); see HoldemCalculator.
+	void SetOrdering(const OrderingTable* ordering) { m_pOrdering = ordering; }
+	void SetTargetError(double targetError) { m_targetError = targetError; }
+	void SetTimeLimit(int64_t timeLimit) { m_timeLimit = timeLimit; }
+	void SetEngine(int engine) { m_engine = engine; }
+	void SetSeed(uint64_t seed) { m_seed = seed; }
+	void SetStratified(bool stratified) { m_stratified = stratified; }
+
+	// Keep the workers on the big cores of a big.LITTLE device when there
+	// are no more workers than big cores (on by default). A worker on a
+	// LITTLE core runs a fraction of the trials for the same battery.
+	void SetBigCoresOnly(bool bigCoresOnly) { m_bigCoresOnly = bigCoresOnly; }
+	void SetCallback(ProgressCallback callback, void* context, int64_t interval);
+
+	// Cancel any running job and start a new one. Returns the number of
+	// players, or 0 if a range could not be parsed or is empty. Spots the
+	// calculators answer exactly (heads-up preflop from the PreflopTable)
+	// finish before Start() returns, with the final callback made from
+	// Start() itself. If a worker can't be started the job is cancelled and
+	// the std::system_error is rethrown.
+	int Start(const char* hands, const char* board, const char* dead, int64_t numberOfTrials, int threads);
+
+	// Best estimate within a wall-clock budget: run on up to maxThreads
+	// workers (0: one per big core, or per core) until budget milliseconds
+	// have passed since the call, or the target error is reached, and wait
+	// for them. Returns the number of players, or 0 if a range could not be
+	// parsed or is empty, and sets trials to the number of trials run.
+	//
+	//		job.Estimate("AA,KK|QQ+,AKs|XxXx", "", "", 150, 4, results, NULL, trials);
+	int Estimate(const char* hands, const char* board, const char* dead, int64_t budget, int maxThreads,
+		double* results, double* errors, int64_t& trials);
+
+	// Ask the workers to stop and return at once; Wait() for them to exit.
+	void Cancel();
+	void Wait();
+
+	bool IsRunning() const { return m_running > 0; }
+	bool IsCancelled() const { return m_cancel; }
+
+	// Copy each player's equity (and, if errors isn't NULL, its standard
+	// error) so far into the arrays. Returns the number of trials so far.
+	int64_t GetResults(double* results, double* errors) const;
+	int GetPlayerCount() const;
+
+	// Seed of the last job started, to run it again.
+	uint64_t GetSeed() const { return m_jobSeed; }
+
+	// The cores with more than the lowest maximum clock rate, read from
+	// cpufreq once. Empty when every core is alike or the rates are unknown.
+	static const vector<int>& GetBigCores();
+
+	// One worker per big core, or per core when they are all alike.
+	static int GetDefaultThreads();
+
+private:
+	int Launch(const char* hands, const char* board, const char* dead, int64_t numberOfTrials, int64_t timeLimit, int threads);
+	void Run(int worker, int threads);
+	int Calculate(int worker, int64_t firstTrial, int64_t numberOfTrials, int64_t timeLimit,
+		double* results, double* errors, int64_t& trials, int64_t& iterations);
+	void Notify(bool always);
+
+	Game m_game;
+	const OrderingTable* m_pOrdering;
+	double m_targetError;
+	int64_t m_timeLimit;
+	int m_engine;
+	uint64_t m_seed;
+	bool m_stratified;
+	bool m_bigCoresOnly;
+	uint64_t m_jobSeed;
+	ProgressCallback m_callback;
+	void* m_context;
+	int64_t m_interval;		// milliseconds between progress updates
+
+	vector<HoldemCalculator*> m_holdem;	// one calculator per worker
+	vector<OmahaCalculator*> m_omaha;
+	vector<thread> m_threads;
+	string m_hands;
+	StdDeck_CardMask m_board;
+	StdDeck_CardMask m_dead;
+	int m_playerCount;
+
+	mutable mutex m_lock;		// guards the statistics and the trials below
+	mutex m_callbackLock;
+	EquityStatistics* m_pStats;
+	int64_t m_jobTimeLimit;		// milliseconds from the statistics' start
+	int64_t m_remaining;		// trials not yet handed to a worker
+	int64_t m_nextTrial;		// first trial number never handed out
+	vector< pair<int64_t, int64_t> > m_returned;	// (first, count) handed back
+	int64_t m_lastNotify;
+	atomic<bool> m_cancel;
+	atomic<int> m_running;
+};
@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include "HandDistributions.h"
+#include "EquityStatistics.h"
+
+const int64_t EquityStatistics::MIN_TRIALS;
+const int64_t EquityStatistics::CHECK_INTERVAL;
+
+EquityStatistics::EquityStatistics(int players, double targetError, int64_t timeLimit)
+    : m_count(0), m_mean(players, 0.0), m_m2(players, 0.0), m_targetError(targetError), m_timeLimit(timeLimit),
+    m_start(std::chrono::steady_clock::now())
+{
+}
+
+EquityStatistics::~EquityStatistics(void)
+{
+}
+
+void EquityStatistics::Add(const double* shares)
+{
+    m_count++;
+    double scale = 1.0 / m_count;
+    for (size_t player = 0; player < m_mean.size(); player++) {
+        double delta = shares[player] - m_mean[player];
+        m_mean[player] += delta * scale;
+        m_m2[player] += delta * (shares[player] - m_mean[player]);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Combine two sets of statistics (Chan et al.). The other run's sum of
+// squared deviations is recovered from its standard error.
+///////////////////////////////////////////////////////////////////////////////
+void EquityStatistics::Merge(int64_t count, const double* means, const double* errors)
+{
+    if (count <= 0)
+        return;
+
+    int64_t total = m_count + count;
+    for (size_t player = 0; player < m_mean.size(); player++) {
+        double delta = means[player] - m_mean[player];
+        double m2 = errors[player] * errors[player] * count * (count - 1);
+        m_mean[player] += delta * count / total;
+        m_m2[player] += m2 + delta * delta * m_count * count / total;
+    }
+    m_count = total;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Standard error of the player's mean share: the sample standard deviation
+// over the square root of the number of trials. results[i] +/- 1.96 times
+// this is a 95% confidence interval for the player's equity.
+///////////////////////////////////////////////////////////////////////////////
+double EquityStatistics::GetStandardError(int player) const
+{
+    if (m_count < 2)
+        return 0.0;
+    return sqrt(m_m2[player] / (m_count - 1) / m_count);
+}
+
+double EquityStatistics::GetMaxStandardError() const
+{
+    double maxError = 0.0;
+    for (size_t player = 0; player < m_mean.size(); player++)
+        maxError = max(maxError, GetStandardError(player));
+    return maxError;
+}
+
+int64_t EquityStatistics::GetElapsed() const
+{
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - m_start;
+    return std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+}
+
+bool EquityStatistics::IsDone() const
+{
+    if (m_targetError > 0.0 && m_count >= MIN_TRIALS && GetMaxStandardError() <= m_targetError)
+        return true;
+
+    return m_timeLimit > 0 && GetElapsed() >= m_timeLimit;
+}
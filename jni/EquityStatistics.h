@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+
+///////////////////////////////////////////////////////////////////////////////
+// Running mean and variance of each player's share of the pot over the
+// trials of a simulation (Welford's method), and the rule that ends the
+// simulation early. A simulation stops as soon as
+//
+//		- every player's standard error is at most the target error, or
+//		- the time limit (in milliseconds) has elapsed
+//
+// whichever comes first; either rule is off when 0. The standard error only
+// gets a say after MIN_TRIALS trials, so a lucky streak at the start can't
+// end a run that has barely begun.
+///////////////////////////////////////////////////////////////////////////////
+class EquityStatistics
+{
+public:
+	EquityStatistics(int players, double targetError, int64_t timeLimit);
+	~EquityStatistics();
+
+	// Record one trial: shares[i] is player i's share of the pot (0..1).
+	void Add(const double* shares);
+
+	// Fold in the results of another run of count trials: each player's mean
+	// share and its standard error, as reported by the calculators.
+	void Merge(int64_t count, const double* means, const double* errors);
+
+	// True when the target error has been reached or time is up. Cheap
+	// enough to call every CHECK_INTERVAL trials, not on every trial.
+	bool IsDone() const;
+
+	int64_t GetCount() const { return m_count; }
+	double GetMean(int player) const { return m_mean[player]; }
+	double GetStandardError(int player) const;
+	double GetMaxStandardError() const;
+
+	// Milliseconds since the statistics were created.
+	int64_t GetElapsed() const;
+
+	static const int64_t MIN_TRIALS = 1000;
+	static const int64_t CHECK_INTERVAL = 64;
+
+private:
+	int64_t m_count;
+	vector<double> m_mean;
+	vector<double> m_m2;		// sum of squared deviations from the mean
+	double m_targetError;
+	int64_t m_timeLimit;
+	std::chrono::steady_clock::time_point m_start;
+};
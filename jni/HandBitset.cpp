@@ -0,0 +1,488 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <inlines/eval.h>
+#include "HandDistributions.h"
+#include "HandBitset.h"
+#include "CardConverter.h"
+
+static const char* const OPERATORS = ",^&!()";
+
+// C(n,k) for n < 53, k <= 4
+struct BinomialTable
+{
+    int c[53][5];
+
+    BinomialTable()
+    {
+        for (int n = 0; n < 53; n++) {
+            c[n][0] = 1;
+            for (int k = 1; k < 5; k++)
+                c[n][k] = n ? c[n-1][k-1] + c[n-1][k] : 0;
+        }
+    }
+};
+
+static int Binomial(int n, int k)
+{
+    static const BinomialTable table;
+    return table.c[n][k];
+}
+
+HandBitset::HandBitset(int holeCards)
+    : m_holeCards(holeCards), m_size(SizeOf(holeCards)), m_words((m_size + 63) / 64, 0)
+{
+}
+
+HandBitset::~HandBitset()
+{
+}
+
+int HandBitset::SizeOf(int holeCards)
+{
+    return Binomial(StdDeck_N_CARDS, holeCards);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Colex index of a hand, or -1 if it doesn't have exactly holeCards cards.
+// The cards of PokerEvalToBits() are numbered as poker-eval numbers them, so
+// only the set bits need visiting.
+///////////////////////////////////////////////////////////////////////////////
+int HandBitset::Index(StdDeck_CardMask hand, int holeCards)
+{
+    return IndexOfBits(CardConverter::PokerEvalToBits(hand), holeCards);
+}
+
+int HandBitset::IndexOfBits(uint64_t hand, int holeCards)
+{
+    if (hand >> StdDeck_N_CARDS)
+        return -1;
+
+    int index = 0, k = 0;
+    for (; hand != 0; hand &= hand - 1) {
+        if (++k > holeCards)
+            return -1;
+        index += Binomial(__builtin_ctzll(hand), k);
+    }
+    return k == holeCards ? index : -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The hand of a colex index, in PokerEvalToBits() form: from the highest
+// card down, each card is the largest c with C(c, k) <= what is left.
+///////////////////////////////////////////////////////////////////////////////
+uint64_t HandBitset::BitsOfIndex(int index, int holeCards)
+{
+    uint64_t hand = 0;
+    int high = StdDeck_N_CARDS;
+    for (int k = holeCards; k > 0; k--) {
+        int low = k - 1;
+        while (high - low > 1) {
+            int mid = (low + high) / 2;
+            if (Binomial(mid, k) <= index)
+                low = mid;
+            else
+                high = mid;
+        }
+        hand |= (uint64_t)1 << low;
+        index -= Binomial(low, k);
+        high = low;
+    }
+    return hand;
+}
+
+void HandBitset::Set(StdDeck_CardMask hand)
+{
+    int index = Index(hand, m_holeCards);
+    if (index >= 0)
+        m_words[index >> 6] |= (uint64_t)1 << (index & 63);
+}
+
+void HandBitset::Set(const vector<StdDeck_CardMask>& hands)
+{
+    for (size_t i = 0; i < hands.size(); i++)
+        Set(hands[i]);
+}
+
+bool HandBitset::Test(StdDeck_CardMask hand) const
+{
+    int index = Index(hand, m_holeCards);
+    return index >= 0 && (m_words[index >> 6] >> (index & 63)) & 1;
+}
+
+void HandBitset::SetWords(const uint64_t* words)
+{
+    memcpy(m_words.data(), words, m_words.size() * sizeof(uint64_t));
+    ClearPadding();
+}
+
+void HandBitset::SetRange(int first, int last)
+{
+    first = max(first, 0);
+    last = min(last, m_size);
+    for (; first < last && (first & 63) != 0; first++)
+        m_words[first >> 6] |= (uint64_t)1 << (first & 63);
+    for (; first + 64 <= last; first += 64)
+        m_words[first >> 6] = ~(uint64_t)0;
+    for (; first < last; first++)
+        m_words[first >> 6] |= (uint64_t)1 << (first & 63);
+}
+
+void HandBitset::Clear()
+{
+    std::fill(m_words.begin(), m_words.end(), 0);
+}
+
+void HandBitset::Fill()
+{
+    std::fill(m_words.begin(), m_words.end(), ~(uint64_t)0);
+    ClearPadding();
+}
+
+// Bits past the last hand must stay clear for Count() and Complement()
+void HandBitset::ClearPadding()
+{
+    if (m_size & 63)
+        m_words.back() &= ((uint64_t)1 << (m_size & 63)) - 1;
+}
+
+int HandBitset::Count() const
+{
+    int count = 0;
+    for (size_t i = 0; i < m_words.size(); i++)
+        count += __builtin_popcountll(m_words[i]);
+    return count;
+}
+
+void HandBitset::Complement()
+{
+    for (size_t i = 0; i < m_words.size(); i++)
+        m_words[i] = ~m_words[i];
+    ClearPadding();
+}
+
+void HandBitset::Or(const HandBitset& other)
+{
+    for (size_t i = 0; i < m_words.size(); i++)
+        m_words[i] |= other.m_words[i];
+}
+
+void HandBitset::And(const HandBitset& other)
+{
+    for (size_t i = 0; i < m_words.size(); i++)
+        m_words[i] &= other.m_words[i];
+}
+
+void HandBitset::AndNot(const HandBitset& other)
+{
+    for (size_t i = 0; i < m_words.size(); i++)
+        m_words[i] &= ~other.m_words[i];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Walk the hands in colex order, so the index of the current hand is just a
+// counter; the successor of a hand bumps its lowest card that can move up
+// and resets the cards below it.
+///////////////////////////////////////////////////////////////////////////////
+int HandBitset::GetHands(StdDeck_CardMask deadCards, vector<StdDeck_CardMask>& hands) const
+{
+    int added = 0;
+    int k = m_holeCards;
+    int cards[4];
+    for (int i = 0; i < k; i++)
+        cards[i] = i;
+
+    for (int index = 0; index < m_size; index++) {
+        if ((m_words[index >> 6] >> (index & 63)) & 1) {
+            StdDeck_CardMask hand;
+            StdDeck_CardMask_RESET(hand);
+            for (int i = 0; i < k; i++)
+                StdDeck_CardMask_SET(hand, cards[i]);
+            if (!StdDeck_CardMask_ANY_SET(hand, deadCards)) {
+                hands.push_back(hand);
+                added++;
+            }
+        }
+
+        int i = 0;
+        while (i < k - 1 && cards[i] + 1 == cards[i + 1]) {
+            cards[i] = i;
+            i++;
+        }
+        cards[i]++;
+    }
+
+    return added;
+}
+
+
+
+struct ExpressionContext
+{
+    HandBitset::OperandCallback callback;
+    void* context;
+    int holeCards;
+};
+
+static bool ParseUnion(const char*& p, ExpressionContext& ctx, HandBitset& result);
+
+static void SkipSpaces(const char*& p)
+{
+    while (*p == ' ')
+        p++;
+}
+
+static bool ParseUnary(const char*& p, ExpressionContext& ctx, HandBitset& result)
+{
+    SkipSpaces(p);
+
+    if (*p == '!') {
+        p++;
+        if (!ParseUnary(p, ctx, result))
+            return false;
+        result.Complement();
+        return true;
+    }
+
+    if (*p == '(') {
+        p++;
+        if (!ParseUnion(p, ctx, result))
+            return false;
+        SkipSpaces(p);
+        if (*p != ')')
+            return false;
+        p++;
+        SkipSpaces(p);
+        return true;
+    }
+
+    const char* start = p;
+    while (*p != '\0' && strchr(OPERATORS, *p) == NULL)
+        p++;
+    const char* end = p;
+    while (end > start && end[-1] == ' ')
+        end--;
+    if (end == start)
+        return false;
+
+    string operand(start, end - start);
+    result.Clear();
+    return ctx.callback(operand.c_str(), result, ctx.context);
+}
+
+static bool ParseIntersection(const char*& p, ExpressionContext& ctx, HandBitset& result)
+{
+    if (!ParseUnary(p, ctx, result))
+        return false;
+
+    while (*p == '&') {
+        p++;
+        HandBitset rhs(ctx.holeCards);
+        if (!ParseUnary(p, ctx, rhs))
+            return false;
+        result.And(rhs);
+    }
+    return true;
+}
+
+static bool ParseDifference(const char*& p, ExpressionContext& ctx, HandBitset& result)
+{
+    if (!ParseIntersection(p, ctx, result))
+        return false;
+
+    while (*p == '^') {
+        p++;
+        HandBitset rhs(ctx.holeCards);
+        if (!ParseIntersection(p, ctx, rhs))
+            return false;
+        result.AndNot(rhs);
+    }
+    return true;
+}
+
+static bool ParseUnion(const char*& p, ExpressionContext& ctx, HandBitset& result)
+{
+    if (!ParseDifference(p, ctx, result))
+        return false;
+
+    while (*p == ',') {
+        p++;
+        HandBitset rhs(ctx.holeCards);
+        if (!ParseDifference(p, ctx, rhs))
+            return false;
+        result.Or(rhs);
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Recursive descent over the grammar described in HandBitset.h. Each operand
+// is expanded once and every operator is a single pass over the bitsets.
+///////////////////////////////////////////////////////////////////////////////
+bool HandBitset::Evaluate(const char* expression, OperandCallback callback, void* context, HandBitset& result)
+{
+    ExpressionContext ctx = { callback, context, result.GetHoleCards() };
+    const char* p = expression;
+
+    result.Clear();
+    if (!ParseUnion(p, ctx, result))
+        return false;
+
+    SkipSpaces(p);
+    return *p == '\0';
+}
+
+struct CheckContext
+{
+    HandBitset::OperandCheck check;
+    void* context;
+    string operand;
+    const char* errorAt;
+    const char* expected;
+};
+
+static bool CheckUnion(const char*& p, CheckContext& ctx);
+
+// Same grammar as ParseUnary() and the operators above, without the sets
+static bool CheckUnary(const char*& p, CheckContext& ctx)
+{
+    SkipSpaces(p);
+    while (*p == '!') {
+        p++;
+        SkipSpaces(p);
+    }
+
+    if (*p == '(') {
+        p++;
+        if (!CheckUnion(p, ctx))
+            return false;
+        SkipSpaces(p);
+        if (*p != ')') {
+            ctx.errorAt = p;
+            ctx.expected = "')'";
+            return false;
+        }
+        p++;
+        SkipSpaces(p);
+        return true;
+    }
+
+    const char* start = p;
+    while (*p != '\0' && strchr(OPERATORS, *p) == NULL)
+        p++;
+    const char* end = p;
+    while (end > start && end[-1] == ' ')
+        end--;
+    if (end == start) {
+        ctx.errorAt = p;
+        ctx.expected = "a hand or range";
+        return false;
+    }
+
+    ctx.operand.assign(start, end - start);
+    if (!ctx.check(ctx.operand.c_str(), ctx.context)) {
+        ctx.errorAt = start;
+        ctx.expected = "";
+        return false;
+    }
+    return true;
+}
+
+static bool CheckUnion(const char*& p, CheckContext& ctx)
+{
+    if (!CheckUnary(p, ctx))
+        return false;
+
+    while (*p == ',' || *p == '^' || *p == '&') {
+        p++;
+        if (!CheckUnary(p, ctx))
+            return false;
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Syntax only, for validating ranges in bulk: no operand is expanded and no
+// set is allocated.
+///////////////////////////////////////////////////////////////////////////////
+const char* HandBitset::CheckExpression(const char* expression, OperandCheck check, void* context, const char*& expected)
+{
+    CheckContext ctx;
+    ctx.check = check;
+    ctx.context = context;
+    ctx.errorAt = NULL;
+    ctx.expected = "";
+
+    const char* p = expression;
+    if (CheckUnion(p, ctx)) {
+        SkipSpaces(p);
+        if (*p == '\0')
+            return NULL;
+        ctx.errorAt = p;
+        ctx.expected = "an operator or the end of the range";
+    }
+
+    expected = ctx.expected;
+    return ctx.errorAt;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Split off the next comma separated term of a range, in place. Commas inside
+// parentheses belong to the term. Empty terms are skipped; returns NULL at
+// the end of the text.
+///////////////////////////////////////////////////////////////////////////////
+char* HandBitset::NextTerm(char*& pText)
+{
+    while (pText != NULL && *pText == ',')
+        pText++;
+    if (pText == NULL || *pText == '\0')
+        return NULL;
+
+    char* pTerm = pText;
+    int depth = 0;
+    for (char* p = pText; ; p++) {
+        if (*p == '(') {
+            depth++;
+        }
+        else if (*p == ')') {
+            depth--;
+        }
+        else if (*p == '\0') {
+            pText = NULL;
+            break;
+        }
+        else if (*p == ',' && depth <= 0) {
+            *p = '\0';
+            pText = p + 1;
+            break;
+        }
+    }
+
+    return pTerm;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// True if the text uses any operator beyond plain comma separated union.
+///////////////////////////////////////////////////////////////////////////////
+bool HandBitset::IsExpression(const char* text)
+{
+    return strpbrk(text, "^&!()") != NULL;
+}
@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// A set of specific hands of one game (2 hole cards for Hold'em, 4 for Omaha)
+// stored as one bit per hand. Hands are numbered in colexicographic order of
+// their sorted cards, c0 < c1 < ... :
+//
+//			index = C(c0,1) + C(c1,2) [+ C(c2,3) + C(c3,4)]
+//
+// so Hold'em uses 1,326 bits and Omaha 270,725 bits (about 33KB). Unions,
+// intersections, differences and complements of ranges are then a single
+// pass over the words.
+///////////////////////////////////////////////////////////////////////////////
+class HandBitset
+{
+public:
+	explicit HandBitset(int holeCards);
+	~HandBitset();
+
+	int GetHoleCards() const { return m_holeCards; }
+	int GetSize() const { return m_size; }
+
+	void Set(StdDeck_CardMask hand);
+	bool Test(StdDeck_CardMask hand) const;
+	void Set(const vector<StdDeck_CardMask>& hands);
+	void Clear();
+	void Fill();
+	int Count() const;
+
+	void Complement();
+	void Or(const HandBitset& other);
+	void And(const HandBitset& other);
+	void AndNot(const HandBitset& other);
+
+	// Append the hands in the set that don't use any of the dead cards.
+	int GetHands(StdDeck_CardMask deadCards, vector<StdDeck_CardMask>& hands) const;
+
+	// The set as words, hand i being bit i % 64 of word i / 64, e.g. to
+	// serialize it (see DistributionCodec).
+	int GetWordCount() const { return (int)m_words.size(); }
+	const uint64_t* GetWords() const { return m_words.data(); }
+	void SetWords(const uint64_t* words);
+	void SetRange(int first, int last);		// hands [first, last)
+
+	static int Index(StdDeck_CardMask hand, int holeCards);
+	static int IndexOfBits(uint64_t hand, int holeCards);	// CardConverter::PokerEvalToBits() form
+	static uint64_t BitsOfIndex(int index, int holeCards);	// the reverse
+	static int SizeOf(int holeCards);
+
+	// Range expressions. Operators, from loosest to tightest binding:
+	//
+	//		a,b		union
+	//		a^b		difference (hands in a that are not in b)
+	//		a&b		intersection
+	//		!a		complement
+	//		(a)		grouping
+	//
+	// Everything else is an operand (a hand, class, range or percent slice),
+	// which the caller expands into a set through the callback. Returns false
+	// on a syntax error or when an operand could not be expanded.
+	typedef bool (*OperandCallback)(const char* operand, HandBitset& hands, void* context);
+	static bool Evaluate(const char* expression, OperandCallback callback, void* context, HandBitset& result);
+
+	// Check the syntax of an expression without building any sets: each
+	// operand is handed to check instead. Returns NULL if the expression is
+	// well formed, else where it goes wrong, with expected set to what
+	// belongs there ("" when check rejected the operand starting there).
+	typedef bool (*OperandCheck)(const char* operand, void* context);
+	static const char* CheckExpression(const char* expression, OperandCheck check, void* context, const char*& expected);
+
+	static bool IsExpression(const char* text);
+	static char* NextTerm(char*& pText);
+
+private:
+	HandBitset(const HandBitset&);
+	void operator=(const HandBitset&);
+
+	void ClearPadding();
+
+	int m_holeCards;
+	int m_size;
+	vector<uint64_t> m_words;
+};
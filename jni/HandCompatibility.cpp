@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <inlines/eval.h>
+#include "HandDistributions.h"
+#include "HandCompatibility.h"
+#include "AliasTable.h"
+#include "RandomEngine.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Hands that share no card with row i are those whose card masks don't
+// intersect it; one pass over the columns per row.
+///////////////////////////////////////////////////////////////////////////////
+HandCompatibility::HandCompatibility(const vector<StdDeck_CardMask>& rows, const vector<StdDeck_CardMask>& columns)
+    : m_rows(rows.size()), m_columns(columns.size()), m_words((columns.size() + 63) / 64),
+      m_bits((size_t)rows.size() * ((columns.size() + 63) / 64), 0)
+{
+    for (int i = 0; i < m_rows; i++) {
+        uint64_t* row = &m_bits[(size_t)i * m_words];
+        for (int j = 0; j < m_columns; j++) {
+            if (!StdDeck_CardMask_ANY_SET(rows[i], columns[j]))
+                row[j >> 6] |= (uint64_t)1 << (j & 63);
+        }
+    }
+}
+
+HandCompatibility::~HandCompatibility()
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// All 1,326 Hold'em hands against each other, in HandBitset order. Built on
+// first use.
+///////////////////////////////////////////////////////////////////////////////
+static vector<StdDeck_CardMask> AllHoldemHands()
+{
+    vector<StdDeck_CardMask> hands;
+    for (int c1 = 1; c1 < StdDeck_N_CARDS; c1++) {
+        for (int c0 = 0; c0 < c1; c0++) {
+            StdDeck_CardMask hand;
+            StdDeck_CardMask_RESET(hand);
+            StdDeck_CardMask_SET(hand, c0);
+            StdDeck_CardMask_SET(hand, c1);
+            hands.push_back(hand);
+        }
+    }
+    return hands;
+}
+
+const HandCompatibility& HandCompatibility::Holdem(void)
+{
+    static const HandCompatibility holdem(AllHoldemHands(), AllHoldemHands());
+    return holdem;
+}
+
+int HandCompatibility::Count(const uint64_t* bits, int words)
+{
+    int count = 0;
+    for (int w = 0; w < words; w++)
+        count += __builtin_popcountll(bits[w]);
+    return count;
+}
+
+int HandCompatibility::Select(const uint64_t* bits, int words, int n)
+{
+    for (int w = 0; w < words; w++) {
+        int count = __builtin_popcountll(bits[w]);
+        if (n < count) {
+            uint64_t word = bits[w];
+            for (int i = 0; i < n; i++)
+                word &= word - 1; // drop the lowest set bit
+            return w * 64 + __builtin_ctzll(word);
+        }
+        n -= count;
+    }
+    return -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Uniform picks are exact: count the possible hands and select one. Weighted
+// picks first try the distribution's alias table, which lands on a possible
+// hand almost every time, and otherwise walk the possible hands' weights.
+///////////////////////////////////////////////////////////////////////////////
+int HandCompatibility::Choose(const uint64_t* possible, int words, const vector<double>& weights,
+    const AliasTable& alias, const int* aliasHands, RandomEngine& rand)
+{
+    int count = Count(possible, words);
+    if (count == 0)
+        return -1;
+
+    if (weights.empty())
+        return Select(possible, words, rand.Below(count));
+
+    for (int attempt = 0; attempt < 4 && !alias.IsEmpty(); attempt++) {
+        int hand = alias.Sample(rand);
+        if (aliasHands != NULL)
+            hand = aliasHands[hand];
+        if ((possible[hand >> 6] >> (hand & 63)) & 1)
+            return hand;
+    }
+
+    double total = 0.0;
+    for (int w = 0; w < words; w++) {
+        for (uint64_t word = possible[w]; word != 0; word &= word - 1)
+            total += weights[w * 64 + __builtin_ctzll(word)];
+    }
+
+    double target = rand() * total;
+    int last = -1;
+    for (int w = 0; w < words; w++) {
+        for (uint64_t word = possible[w]; word != 0; word &= word - 1) {
+            last = w * 64 + __builtin_ctzll(word);
+            target -= weights[last];
+            if (target < 0.0)
+                return last;
+        }
+    }
+
+    return last;
+}
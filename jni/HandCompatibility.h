@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Which hands of one range can be dealt together with which hands of another:
+// row i has bit j set when rows[i] and columns[j] don't share a card. The
+// hands still possible for a player once the earlier players' hands are
+// known are then the AND of one row per earlier player, a few words per row
+// instead of trial and error in Choose().
+//
+// The Hold'em matrix over all 1,326 hands (numbered as in HandBitset) is
+// fixed and shared (220KB). For Omaha a matrix is built per pair of ranges
+// on demand; GetFootprint() tells what it would cost first.
+///////////////////////////////////////////////////////////////////////////////
+class AliasTable;
+class RandomEngine;
+
+class HandCompatibility
+{
+public:
+	HandCompatibility(const vector<StdDeck_CardMask>& rows, const vector<StdDeck_CardMask>& columns);
+	~HandCompatibility();
+
+	static const HandCompatibility& Holdem();
+	static size_t GetFootprint(size_t rows, size_t columns) { return rows * ((columns + 63) / 64) * sizeof(uint64_t); }
+
+	int GetRows() const { return m_rows; }
+	int GetColumns() const { return m_columns; }
+	int GetWords() const { return m_words; }
+	const uint64_t* Row(int row) const { return &m_bits[(size_t)row * m_words]; }
+	bool IsCompatible(int row, int column) const { return (Row(row)[column >> 6] >> (column & 63)) & 1; }
+
+	// Helpers for the bit vectors the rows are combined into.
+	static int Count(const uint64_t* bits, int words);
+	static int Select(const uint64_t* bits, int words, int n);	// position of the nth set bit
+
+	// Pick one of the hands set in possible[], uniformly if weights is empty
+	// and otherwise with probability proportional to weights[hand]. alias
+	// samples a distribution's hands by weight and aliasHands maps them to
+	// bit positions (NULL if they are the same). Returns -1 if no hand is
+	// possible.
+	static int Choose(const uint64_t* possible, int words, const vector<double>& weights,
+		const AliasTable& alias, const int* aliasHands, RandomEngine& rand);
+
+private:
+	HandCompatibility(const HandCompatibility&);
+	void operator=(const HandCompatibility&);
+
+	int m_rows;
+	int m_columns;
+	int m_words;
+	vector<uint64_t> m_bits;
+};
@@ -0,0 +1,365 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <inlines/eval_omaha.h>
+#include <new>
+#include <system_error>
+#include "HandDistributions.h"
+#include "HandDistApi.h"
+#include "HoldemHandDistribution.h"
+#include "OmahaHandDistribution.h"
+#include "EquityJob.h"
+#include "CardConverter.h"
+#include "RandomEngine.h"
+#include "DistributionCodec.h"
+#include "RangeCache.h"
+
+// A distribution handle holds one distribution of its game
+struct hd_distribution
+{
+    int game;
+    HoldemHandDistribution* holdem;
+    OmahaHandDistribution* omaha;
+};
+
+struct hd_job
+{
+    EquityJob* job;
+};
+
+static bool IsGame(int game)
+{
+    return game == HD_HOLDEM || game == HD_OMAHA || game == HD_OMAHA_HILO;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The calls shared by both distribution classes, on whichever one the handle
+// holds.
+///////////////////////////////////////////////////////////////////////////////
+template <class Distribution>
+static void Instantiate(const Distribution* pDist, uint64_t* hands, double* weights)
+{
+    for (int i = 0; i < pDist->GetCount(); i++) {
+        hands[i] = CardConverter::PokerEvalToBits(pDist->Get(i));
+        if (weights != NULL)
+            weights[i] = pDist->GetWeight(i);
+    }
+}
+
+template <class Distribution>
+static void Choose(Distribution* pDist, StdDeck_CardMask dead, RandomEngine& rand, uint64_t first, uint64_t* hands, int64_t count)
+{
+    for (int64_t i = 0; i < count; i++) {
+        rand.Seek(first + i);
+        bool collision = false;
+        StdDeck_CardMask hand = pDist->Choose(dead, collision, rand);
+        hands[i] = collision ? 0 : CardConverter::PokerEvalToBits(hand);
+    }
+}
+
+extern "C" {
+
+const char* hd_error_text(int status)
+{
+    switch (status) {
+    case HD_OK:
+        return "ok";
+    case HD_ERROR_ARGUMENT:
+        return "bad argument";
+    case HD_ERROR_RANGE:
+        return "range could not be parsed or is empty";
+    case HD_ERROR_BUFFER:
+        return "buffer too small";
+    case HD_ERROR_MEMORY:
+        return "out of memory";
+    case HD_ERROR_THREAD:
+        return "could not start a worker thread";
+    }
+    return "unknown error";
+}
+
+int hd_distribution_parse(int game, const char* text, uint64_t dead, hd_distribution** distribution)
+{
+    if (text == NULL || distribution == NULL || !IsGame(game))
+        return HD_ERROR_ARGUMENT;
+    *distribution = NULL;
+
+    hd_distribution* handle = new (std::nothrow) hd_distribution;
+    if (handle == NULL)
+        return HD_ERROR_MEMORY;
+    handle->game = game;
+    handle->holdem = NULL;
+    handle->omaha = NULL;
+
+    int count = 0;
+    StdDeck_CardMask deadCards = CardConverter::BitsToPokerEval(dead);
+    try {
+        if (game == HD_HOLDEM) {
+            handle->holdem = new HoldemHandDistribution();
+            count = handle->holdem->Init(text, deadCards);
+        }
+        else {
+            handle->omaha = new OmahaHandDistribution();
+            count = handle->omaha->Init(text, deadCards);
+        }
+    }
+    catch (std::bad_alloc&) {
+        hd_distribution_free(handle);
+        return HD_ERROR_MEMORY;
+    }
+
+    if (count == 0) {
+        hd_distribution_free(handle);
+        return HD_ERROR_RANGE;
+    }
+
+    *distribution = handle;
+    return HD_OK;
+}
+
+int hd_distribution_validate(int game, const char* text, int* offset, char* message, int capacity)
+{
+    if (text == NULL || !IsGame(game) || (message != NULL && capacity <= 0))
+        return HD_ERROR_ARGUMENT;
+
+    ParseError error;
+    bool valid;
+    try {
+        if (game == HD_HOLDEM)
+            valid = HoldemHandDistribution::Validate(text, &error);
+        else
+            valid = OmahaHandDistribution::Validate(text, &error);
+    }
+    catch (std::bad_alloc&) {
+        return HD_ERROR_MEMORY;
+    }
+
+    if (offset != NULL)
+        *offset = error.offset;
+    if (message != NULL)
+        error.Format(message, capacity);
+    return valid ? HD_OK : HD_ERROR_RANGE;
+}
+
+void hd_distribution_free(hd_distribution* distribution)
+{
+    if (distribution == NULL)
+        return;
+    delete distribution->holdem;
+    delete distribution->omaha;
+    delete distribution;
+}
+
+int hd_distribution_count(const hd_distribution* distribution, int64_t* count, int64_t* live)
+{
+    if (distribution == NULL)
+        return HD_ERROR_ARGUMENT;
+
+    if (count != NULL)
+        *count = distribution->holdem ? distribution->holdem->GetCount() : distribution->omaha->GetCount();
+    if (live != NULL)
+        *live = distribution->holdem ? distribution->holdem->GetLiveCount() : distribution->omaha->GetLiveCount();
+    return HD_OK;
+}
+
+int hd_distribution_instantiate(const hd_distribution* distribution, uint64_t* hands, double* weights,
+    int64_t capacity, int64_t* count)
+{
+    if (distribution == NULL || hands == NULL || count == NULL)
+        return HD_ERROR_ARGUMENT;
+
+    *count = distribution->holdem ? distribution->holdem->GetCount() : distribution->omaha->GetCount();
+    if (*count > capacity)
+        return HD_ERROR_BUFFER;
+
+    if (distribution->holdem)
+        Instantiate(distribution->holdem, hands, weights);
+    else
+        Instantiate(distribution->omaha, hands, weights);
+    return HD_OK;
+}
+
+int hd_distribution_encode(const hd_distribution* distribution, uint8_t* buffer, int64_t capacity, int64_t* size)
+{
+    if (distribution == NULL || buffer == NULL || size == NULL)
+        return HD_ERROR_ARGUMENT;
+
+    vector<uint8_t> bytes;
+    try {
+        if (distribution->holdem)
+            DistributionCodec::Encode(*distribution->holdem, bytes);
+        else
+            DistributionCodec::Encode(*distribution->omaha, bytes);
+    }
+    catch (std::bad_alloc&) {
+        return HD_ERROR_MEMORY;
+    }
+
+    *size = bytes.size();
+    if (*size > capacity)
+        return HD_ERROR_BUFFER;
+    memcpy(buffer, bytes.data(), bytes.size());
+    return HD_OK;
+}
+
+int hd_distribution_decode(int game, const uint8_t* data, int64_t size, hd_distribution** distribution)
+{
+    if (data == NULL || size < 0 || distribution == NULL || !IsGame(game))
+        return HD_ERROR_ARGUMENT;
+    *distribution = NULL;
+
+    hd_distribution* handle = new (std::nothrow) hd_distribution;
+    if (handle == NULL)
+        return HD_ERROR_MEMORY;
+    handle->game = game;
+    handle->holdem = NULL;
+    handle->omaha = NULL;
+
+    bool decoded;
+    try {
+        if (game == HD_HOLDEM) {
+            handle->holdem = new HoldemHandDistribution();
+            decoded = DistributionCodec::Decode(data, (size_t)size, *handle->holdem);
+        }
+        else {
+            handle->omaha = new OmahaHandDistribution();
+            decoded = DistributionCodec::Decode(data, (size_t)size, *handle->omaha);
+        }
+    }
+    catch (std::bad_alloc&) {
+        hd_distribution_free(handle);
+        return HD_ERROR_MEMORY;
+    }
+
+    if (!decoded) {
+        hd_distribution_free(handle);
+        return HD_ERROR_RANGE;
+    }
+
+    *distribution = handle;
+    return HD_OK;
+}
+
+int hd_distribution_set_dead(hd_distribution* distribution, uint64_t dead)
+{
+    if (distribution == NULL)
+        return HD_ERROR_ARGUMENT;
+
+    StdDeck_CardMask deadCards = CardConverter::BitsToPokerEval(dead);
+    if (distribution->holdem)
+        distribution->holdem->SetDeadCards(deadCards);
+    else
+        distribution->omaha->SetDeadCards(deadCards);
+    return HD_OK;
+}
+
+int hd_distribution_choose(hd_distribution* distribution, uint64_t dead, uint64_t seed, uint64_t first,
+    uint64_t* hands, int64_t count)
+{
+    if (distribution == NULL || (hands == NULL && count > 0) || count < 0)
+        return HD_ERROR_ARGUMENT;
+
+    PhiloxEngine rand(seed);
+    StdDeck_CardMask deadCards = CardConverter::BitsToPokerEval(dead);
+    if (distribution->holdem)
+        Choose(distribution->holdem, deadCards, rand, first, hands, count);
+    else
+        Choose(distribution->omaha, deadCards, rand, first, hands, count);
+    return HD_OK;
+}
+
+int hd_distribution_set_cache(const char* directory)
+{
+    try {
+        return RangeCache::SetDirectory(directory) ? HD_OK : HD_ERROR_ARGUMENT;
+    }
+    catch (std::bad_alloc&) {
+        return HD_ERROR_MEMORY;
+    }
+}
+
+int hd_job_create(int game, hd_job** job)
+{
+    if (job == NULL || !IsGame(game))
+        return HD_ERROR_ARGUMENT;
+    *job = NULL;
+
+    hd_job* handle = new (std::nothrow) hd_job;
+    if (handle == NULL)
+        return HD_ERROR_MEMORY;
+    try {
+        handle->job = new EquityJob((EquityJob::Game)game);
+    }
+    catch (std::bad_alloc&) {
+        delete handle;
+        return HD_ERROR_MEMORY;
+    }
+
+    *job = handle;
+    return HD_OK;
+}
+
+void hd_job_free(hd_job* job)
+{
+    if (job == NULL)
+        return;
+    delete job->job;
+    delete job;
+}
+
+int hd_job_equity(hd_job* job, const char* hands, const char* board, const char* dead,
+    int64_t trials, int64_t budget, int threads, uint64_t seed,
+    double* equities, double* errors, int capacity, int* players, int64_t* trialsRun)
+{
+    if (job == NULL || hands == NULL || equities == NULL || players == NULL || trialsRun == NULL)
+        return HD_ERROR_ARGUMENT;
+    *players = 0;
+    *trialsRun = 0;
+
+    if (std::count(hands, hands + strlen(hands), '|') + 1 > capacity)
+        return HD_ERROR_BUFFER;
+
+    EquityJob* pJob = job->job;
+    pJob->SetSeed(seed);
+    try {
+        if (budget > 0) {
+            *players = pJob->Estimate(hands, board, dead, budget, threads, equities, errors, *trialsRun);
+        }
+        else {
+            *players = pJob->Start(hands, board, dead, trials, threads < 1 ? EquityJob::GetDefaultThreads() : threads);
+            pJob->Wait();
+            if (*players > 0)
+                *trialsRun = pJob->GetResults(equities, errors);
+        }
+    }
+    catch (std::bad_alloc&) {
+        *players = 0;
+        return HD_ERROR_MEMORY;
+    }
+    catch (std::system_error&) {
+        *players = 0;
+        return HD_ERROR_THREAD;
+    }
+
+    return *players > 0 ? HD_OK : HD_ERROR_RANGE;
+}
+
+}
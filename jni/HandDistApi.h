@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Plain C interface to the library, for callers in other languages (Python
+// ctypes/cffi, Go cgo, Rust FFI). This header includes nothing from the C++
+// side. Objects are opaque handles; every output goes into buffers the
+// caller allocates; every function returns HD_OK or a negative HD_ERROR_*
+// code (see hd_error_text).
+//
+// Cards are 64 bit masks with bit 13 * suit + rank set for each card
+// (rank 0 = deuce .. 12 = ace; suits hearts, diamonds, clubs, spades).
+//
+//		hd_distribution* range;
+//		if (hd_distribution_parse(HD_HOLDEM, "QQ+,AKs", 0, &range) == HD_OK) {
+//			uint64_t hands[64];
+//			int64_t count;
+//			hd_distribution_instantiate(range, hands, NULL, 64, &count);
+//			hd_distribution_free(range);
+//		}
+//
+// Handles may be used from any thread, but not from two at once.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HD_OK					0
+#define HD_ERROR_ARGUMENT		-1		// NULL handle or pointer, unknown game
+#define HD_ERROR_RANGE			-2		// a range could not be parsed or is empty
+#define HD_ERROR_BUFFER			-3		// output buffer too small
+#define HD_ERROR_MEMORY			-4		// out of memory
+#define HD_ERROR_THREAD			-5		// a worker thread could not be started
+
+#define HD_HOLDEM				0
+#define HD_OMAHA				1
+#define HD_OMAHA_HILO			2
+
+typedef struct hd_distribution hd_distribution;
+typedef struct hd_job hd_job;
+
+// Short description of a status code, e.g. for an exception message.
+const char* hd_error_text(int status);
+
+///////////////////////////////////////////////////////////////////////////////
+// Distributions: a compiled range and its specific hands.
+///////////////////////////////////////////////////////////////////////////////
+
+// Parse text (e.g. "QQ+,AKs:0.5" or "[AK]xx") into a new distribution,
+// leaving out hands that hold a dead card.
+int hd_distribution_parse(int game, const char* text, uint64_t dead, hd_distribution** distribution);
+void hd_distribution_free(hd_distribution* distribution);
+
+// Check the syntax of text without building a distribution, e.g. to vet a
+// library of ranges. Returns HD_OK or HD_ERROR_RANGE; *offset (if offset
+// isn't NULL) gets the position of the first error in text, or -1, and
+// message (if not NULL) a description of it, cut to capacity bytes.
+int hd_distribution_validate(int game, const char* text, int* offset, char* message, int capacity);
+
+// Number of hands, and of those not blocked by the dead cards of the last
+// hd_distribution_set_dead (either pointer may be NULL).
+int hd_distribution_count(const hd_distribution* distribution, int64_t* count, int64_t* live);
+
+// Copy the hands (and, if weights isn't NULL, their weights) into arrays of
+// capacity entries. *count is set to the number of hands either way; with
+// too small a buffer nothing is copied and HD_ERROR_BUFFER is returned.
+int hd_distribution_instantiate(const hd_distribution* distribution, uint64_t* hands, double* weights,
+	int64_t capacity, int64_t* count);
+
+// Write the distribution in its compact binary form (see DistributionCodec.h)
+// to send to another process or keep on disk. *size is set either way; with
+// too small a buffer nothing is written and HD_ERROR_BUFFER is returned.
+int hd_distribution_encode(const hd_distribution* distribution, uint8_t* buffer, int64_t capacity, int64_t* size);
+
+// A new distribution of game from the output of hd_distribution_encode.
+int hd_distribution_decode(int game, const uint8_t* data, int64_t size, hd_distribution** distribution);
+
+// Keep hands holding a dead card (e.g. the board) from being chosen.
+int hd_distribution_set_dead(hd_distribution* distribution, uint64_t dead);
+
+// Choose count hands by weight, avoiding the dead cards: hands[i] is drawn
+// from stream first + i of seed, so the same arguments choose the same
+// hands. hands[i] is 0 when no hand could be chosen.
+int hd_distribution_choose(hd_distribution* distribution, uint64_t dead, uint64_t seed, uint64_t first,
+	uint64_t* hands, int64_t count);
+
+// Keep wide ranges parsed from now on in directory (created if missing) and
+// map them from there instead of parsing them again, in this process and
+// later ones (see RangeCache.h). NULL or "" turns the cache off; a directory
+// that can't be used returns HD_ERROR_ARGUMENT.
+int hd_distribution_set_cache(const char* directory);
+
+///////////////////////////////////////////////////////////////////////////////
+// Equity jobs: simulations on a pool of worker threads that keeps the parsed
+// ranges from one call to the next.
+///////////////////////////////////////////////////////////////////////////////
+
+int hd_job_create(int game, hd_job** job);
+void hd_job_free(hd_job* job);
+
+// Simulate hands (ranges separated by '|') on board with dead cards removed
+// (board and dead are text such as "AhKd7c" and may be empty or NULL). The
+// run lasts trials trials or, when budget is positive, budget milliseconds,
+// on up to threads workers (0: one per big core). seed 0 picks a new seed.
+// equities and errors (errors may be NULL) have room for capacity players;
+// *players and *trialsRun are set on success. HD_ERROR_THREAD means no
+// worker could be started, or one of them could not.
+int hd_job_equity(hd_job* job, const char* hands, const char* board, const char* dead,
+	int64_t trials, int64_t budget, int threads, uint64_t seed,
+	double* equities, double* errors, int capacity, int* players, int64_t* trialsRun);
+
+#ifdef __cplusplus
+}
+#endif
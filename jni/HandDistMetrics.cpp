@@ -0,0 +1,209 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "HandDistributions.h"
+#include "HandDistMetrics.h"
+
+const int HandDistMetrics::BUCKETS;
+
+static const char* const COUNTER_NAMES[HandDistMetrics::CounterCount] =
+{
+    "init_calls",
+    "percent_ranges",
+    "choose_calls",
+    "choose_attempts",
+    "choose_collisions",
+    "trials",
+    "trial_collisions",
+    "cache_hits",
+    "cache_stores"
+};
+
+static const char* const HISTOGRAM_NAMES[HandDistMetrics::HistogramCount] =
+{
+    "init_ns",
+    "parse_ns",
+    "instantiate_specific_ns",
+    "instantiate_class_ns",
+    "instantiate_percent_ns",
+    "instantiate_random_ns",
+    "instantiate_expression_ns",
+    "dedupe_ns",
+    "range_hands"
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// One thread's counts. Only the owning thread writes them, so the updates
+// are relaxed loads and stores rather than read-modify-writes; snapshots may
+// read a block while it is being written and see a count a moment old.
+///////////////////////////////////////////////////////////////////////////////
+struct HandDistMetrics::Block
+{
+    atomic<uint64_t> counters[CounterCount];
+    atomic<uint64_t> counts[HistogramCount];
+    atomic<uint64_t> totals[HistogramCount];
+    atomic<uint64_t> buckets[HistogramCount][BUCKETS];
+
+    Block() { Clear(); }
+
+    void Clear()
+    {
+        for (int i = 0; i < CounterCount; i++)
+            counters[i].store(0, memory_order_relaxed);
+        for (int i = 0; i < HistogramCount; i++) {
+            counts[i].store(0, memory_order_relaxed);
+            totals[i].store(0, memory_order_relaxed);
+            for (int b = 0; b < BUCKETS; b++)
+                buckets[i][b].store(0, memory_order_relaxed);
+        }
+    }
+
+    void AddTo(Snapshot& snapshot) const
+    {
+        for (int i = 0; i < CounterCount; i++)
+            snapshot.counters[i] += counters[i].load(memory_order_relaxed);
+        for (int i = 0; i < HistogramCount; i++) {
+            snapshot.histograms[i].count += counts[i].load(memory_order_relaxed);
+            snapshot.histograms[i].total += totals[i].load(memory_order_relaxed);
+            for (int b = 0; b < BUCKETS; b++)
+                snapshot.histograms[i].buckets[b] += buckets[i][b].load(memory_order_relaxed);
+        }
+    }
+};
+
+static inline void Bump(atomic<uint64_t>& value, uint64_t count)
+{
+    value.store(value.load(memory_order_relaxed) + count, memory_order_relaxed);
+}
+
+// The blocks of the running threads, and the sum of those that have exited
+static mutex s_lock;
+static vector<HandDistMetrics::Block*>* s_pBlocks;
+static HandDistMetrics::Snapshot s_retired;
+
+namespace {
+
+// Registers its thread's block on first use and retires it at thread exit
+struct BlockOwner
+{
+    HandDistMetrics::Block* pBlock;
+
+    BlockOwner() : pBlock(new HandDistMetrics::Block)
+    {
+        lock_guard<mutex> lock(s_lock);
+        if (s_pBlocks == NULL)
+            s_pBlocks = new vector<HandDistMetrics::Block*>;
+        s_pBlocks->push_back(pBlock);
+    }
+
+    ~BlockOwner()
+    {
+        lock_guard<mutex> lock(s_lock);
+        pBlock->AddTo(s_retired);
+        s_pBlocks->erase(find(s_pBlocks->begin(), s_pBlocks->end(), pBlock));
+        delete pBlock;
+    }
+};
+
+}
+
+HandDistMetrics::Block& HandDistMetrics::GetBlock()
+{
+    static thread_local BlockOwner owner;
+    return *owner.pBlock;
+}
+
+bool HandDistMetrics::IsEnabled()
+{
+#ifdef HANDDIST_METRICS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void HandDistMetrics::Add(Counter counter, uint64_t count)
+{
+    Bump(GetBlock().counters[counter], count);
+}
+
+void HandDistMetrics::Record(Histogram histogram, uint64_t value)
+{
+    int bucket = value == 0 ? 0 : min(BUCKETS - 1, 64 - __builtin_clzll(value));
+    Block& block = GetBlock();
+    Bump(block.counts[histogram], 1);
+    Bump(block.totals[histogram], value);
+    Bump(block.buckets[histogram][bucket], 1);
+}
+
+void HandDistMetrics::GetSnapshot(Snapshot& snapshot)
+{
+    lock_guard<mutex> lock(s_lock);
+    snapshot = s_retired;
+    if (s_pBlocks != NULL) {
+        for (size_t i = 0; i < s_pBlocks->size(); i++)
+            (*s_pBlocks)[i]->AddTo(snapshot);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Counts added by other threads while the blocks are cleared may survive.
+///////////////////////////////////////////////////////////////////////////////
+void HandDistMetrics::Reset()
+{
+    lock_guard<mutex> lock(s_lock);
+    memset(&s_retired, 0, sizeof(s_retired));
+    if (s_pBlocks != NULL) {
+        for (size_t i = 0; i < s_pBlocks->size(); i++)
+            (*s_pBlocks)[i]->Clear();
+    }
+}
+
+const char* HandDistMetrics::GetName(Counter counter)
+{
+    return (unsigned)counter < CounterCount ? COUNTER_NAMES[counter] : "";
+}
+
+const char* HandDistMetrics::GetName(Histogram histogram)
+{
+    return (unsigned)histogram < HistogramCount ? HISTOGRAM_NAMES[histogram] : "";
+}
+
+uint64_t HandDistMetrics::Distribution::GetPercentile(double fraction) const
+{
+    if (count == 0)
+        return 0;
+
+    uint64_t rank = (uint64_t)(fraction * count);
+    uint64_t seen = 0;
+    for (int b = 0; b < BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen > rank)
+            return b == 0 ? 0 : ((uint64_t)1 << b) - 1;
+    }
+    return ((uint64_t)1 << (BUCKETS - 1)) - 1;
+}
+
+double HandDistMetrics::Snapshot::GetCollisionRate() const
+{
+    uint64_t all = counters[Trials] + counters[TrialCollisions];
+    return all > 0 ? (double)counters[TrialCollisions] / all : 0.0;
+}
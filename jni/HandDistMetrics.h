@@ -0,0 +1,145 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+
+///////////////////////////////////////////////////////////////////////////////
+// Counters and latency histograms of the library's hot paths: range parsing
+// and instantiation by kind of term, duplicate removal, percent range
+// resolution, Choose() attempts and collisions, trials thrown out by the
+// calculators, and RangeCache hits and stores.
+//
+// The probes are the HANDDIST_* macros below, which compile to nothing
+// unless HANDDIST_METRICS is defined (see Android.mk), so a normal build
+// pays nothing. With it, every thread counts into its own block without
+// locking; GetSnapshot() adds up the blocks of all threads, including those
+// that have exited.
+//
+//		HandDistMetrics::Snapshot snapshot;
+//		HandDistMetrics::GetSnapshot(snapshot);
+//		printf("collisions %.3f%%\n", 100.0 * snapshot.GetCollisionRate());
+///////////////////////////////////////////////////////////////////////////////
+class HandDistMetrics
+{
+public:
+	enum Counter
+	{
+		InitCalls,				// distributions initialized
+		PercentRanges,			// percent ranges resolved against a table
+		ChooseCalls,			// Choose() on a distribution of several hands
+		ChooseAttempts,			// hands drawn by those calls
+		ChooseCollisions,		// calls that found every draw blocked
+		Trials,					// trials completed by the calculators
+		TrialCollisions,		// trials thrown out for a player with no hand
+		CacheHits,				// distributions read from the RangeCache
+		CacheStores,			// distributions written to it
+		CounterCount
+	};
+
+	enum Histogram
+	{
+		InitTime,					// whole of a distribution's Init()
+		ParseTime,					// agnostic hand Parse()
+		InstantiateSpecificTime,	// "AhKd"
+		InstantiateClassTime,		// "AKs", "QJs+", "TT-77", "[AK]xx"
+		InstantiatePercentTime,		// "15%", "10-25%"
+		InstantiateRandomTime,		// "XxXx", "XXXX"
+		InstantiateExpressionTime,	// "(QQ+,AK)^AsKs"
+		DedupeTime,					// sort and unique of the hands
+		RangeHands,					// hands per distribution (a count, not a time)
+		HistogramCount
+	};
+
+	// Bucket i counts values v with 2^(i-1) <= v < 2^i (bucket 0 is v = 0);
+	// times are in nanoseconds.
+	static const int BUCKETS = 40;
+
+	struct Distribution
+	{
+		uint64_t count;
+		uint64_t total;
+		uint64_t buckets[BUCKETS];
+
+		double GetMean() const { return count > 0 ? (double)total / count : 0.0; }
+
+		// Upper bound of the bucket holding the given fraction (0..1) of the
+		// values, e.g. 0.99 for the 99th percentile.
+		uint64_t GetPercentile(double fraction) const;
+	};
+
+	struct Snapshot
+	{
+		uint64_t counters[CounterCount];
+		Distribution histograms[HistogramCount];
+
+		// Fraction of the calculators' trials thrown out for a collision
+		double GetCollisionRate() const;
+	};
+
+	// Whether the library was built with HANDDIST_METRICS; without it every
+	// snapshot is zero.
+	static bool IsEnabled();
+
+	static void Add(Counter counter, uint64_t count);
+	static void Record(Histogram histogram, uint64_t value);
+
+	static void GetSnapshot(Snapshot& snapshot);
+	static void Reset();
+
+	static const char* GetName(Counter counter);
+	static const char* GetName(Histogram histogram);
+
+	// A thread's counts (see HandDistMetrics.cpp)
+	struct Block;
+
+	// Records the time from its construction to its destruction
+	class Timer
+	{
+	public:
+		explicit Timer(Histogram histogram) : m_histogram(histogram), m_start(chrono::steady_clock::now()) { }
+		~Timer() { Record(m_histogram, chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - m_start).count()); }
+
+		void Set(Histogram histogram) { m_histogram = histogram; }
+
+	private:
+		Histogram m_histogram;
+		chrono::steady_clock::time_point m_start;
+	};
+
+private:
+	HandDistMetrics(void) { }
+
+	static Block& GetBlock();
+};
+
+#ifdef HANDDIST_METRICS
+#define HANDDIST_COUNT(counter, count)		HandDistMetrics::Add(HandDistMetrics::counter, (count))
+#define HANDDIST_RECORD(histogram, value)	HandDistMetrics::Record(HandDistMetrics::histogram, (value))
+#define HANDDIST_TIMER(name, histogram)		HandDistMetrics::Timer name(HandDistMetrics::histogram)
+#define HANDDIST_TIMER_SET(name, histogram)	name.Set(HandDistMetrics::histogram)
+#else
+#define HANDDIST_COUNT(counter, count)		do { } while (0)
+#define HANDDIST_RECORD(histogram, value)	do { } while (0)
+#define HANDDIST_TIMER(name, histogram)		do { } while (0)
+#define HANDDIST_TIMER_SET(name, histogram)	do { } while (0)
+#endif
@@ -22,10 +22,13 @@
 
 #include <cstdint>
 #include <cstring>
+#include <string>
 #include <list>
 #include <vector>
 #include <algorithm>
 #include <cassert>
+#include <mutex>
+#include <atomic>
 using namespace std;
 
 #ifdef NDEBUG
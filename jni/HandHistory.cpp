@@ -0,0 +1,613 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <inlines/eval.h>
+#include "HandDistributions.h"
+#include "HandHistory.h"
+#include "HandBitset.h"
+#include "HandRanking.h"
+#include "EquityJob.h"
+#include "Card.h"
+
+const size_t HandHistoryParser::MAX_HAND_SIZE;
+
+// Bytes of a file mapped at a time (plus MAX_HAND_SIZE for the last hand)
+static const size_t MAP_WINDOW = 64 << 20;
+
+// First line of a hand, by site
+static const struct
+{
+    const char* text;
+    size_t length;
+    HandRecord::Site site;
+} HAND_HEADERS[] =
+{
+    { "PokerStars Hand #", 17, HandRecord::PokerStars },
+    { "PokerStars Zoom Hand #", 22, HandRecord::PokerStars },
+    { "PokerStars Game #", 17, HandRecord::PokerStars },
+    { "Poker Hand #", 12, HandRecord::GGPoker }
+};
+
+static const int HAND_HEADER_COUNT = sizeof(HAND_HEADERS) / sizeof(HAND_HEADERS[0]);
+
+int HandRecord::FindSeat(int seat) const
+{
+    for (int player = 0; player < playerCount; player++) {
+        if (players[player].seat == seat)
+            return player;
+    }
+    return -1;
+}
+
+static bool StartsWith(const char* p, const char* end, const char* prefix)
+{
+    size_t length = strlen(prefix);
+    return (size_t)(end - p) >= length && memcmp(p, prefix, length) == 0;
+}
+
+// First occurrence of text in [p, end), or NULL
+static const char* Find(const char* p, const char* end, const char* text)
+{
+    size_t length = strlen(text);
+    for (; (size_t)(end - p) >= length; p++) {
+        p = (const char*)memchr(p, text[0], end - p - length + 1);
+        if (p == NULL)
+            return NULL;
+        if (memcmp(p, text, length) == 0)
+            return p;
+    }
+    return NULL;
+}
+
+// Header of the hand starting at p, or -1. A UTF-8 byte order mark may
+// precede the first hand of a file.
+static int HandHeader(const char* p, const char* end)
+{
+    if (end - p >= 3 && memcmp(p, "\xEF\xBB\xBF", 3) == 0)
+        p += 3;
+
+    if (p == end || *p != 'P')
+        return -1;
+
+    for (int header = 0; header < HAND_HEADER_COUNT; header++) {
+        if ((size_t)(end - p) >= HAND_HEADERS[header].length && memcmp(p, HAND_HEADERS[header].text, HAND_HEADERS[header].length) == 0)
+            return header;
+    }
+    return -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// An amount such as "$1,234.56", "€0.05" or "1500", in hundredths. Currency
+// signs before the number are skipped. Returns the end of the number, or
+// NULL if there is none.
+///////////////////////////////////////////////////////////////////////////////
+static const char* ParseAmount(const char* p, const char* end, int64_t& amount)
+{
+    while (p < end && !isdigit((unsigned char)*p) && *p != ' ' && *p != '/' && *p != ')')
+        p++;
+    if (p == end || !isdigit((unsigned char)*p))
+        return NULL;
+
+    int64_t whole = 0;
+    for (; p < end && (isdigit((unsigned char)*p) || *p == ','); p++) {
+        if (*p != ',')
+            whole = whole * 10 + (*p - '0');
+    }
+
+    int64_t hundredths = 0;
+    if (p + 1 < end && *p == '.' && isdigit((unsigned char)p[1])) {
+        int digits = 0;
+        for (p++; p < end && isdigit((unsigned char)*p); p++, digits++) {
+            if (digits < 2)
+                hundredths = hundredths * 10 + (*p - '0');
+        }
+        if (digits == 1)
+            hundredths *= 10;
+    }
+
+    amount = whole * 100 + hundredths;
+    return p;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The cards of every "[Ah Kd]" group in [p, end).
+///////////////////////////////////////////////////////////////////////////////
+static StdDeck_CardMask ParseCards(const char* p, const char* end)
+{
+    StdDeck_CardMask cards;
+    StdDeck_CardMask_RESET(cards);
+
+    bool inGroup = false;
+    while (p < end) {
+        if (*p == '[') {
+            inGroup = true;
+            p++;
+        }
+        else if (*p == ']') {
+            inGroup = false;
+            p++;
+        }
+        else if (inGroup && *p != ' ' && p + 1 < end) {
+            int rank = Card::CharToRank(*p);
+            const char* suit = p + 1;
+            if (*p == '1' && *suit == '0' && p + 2 < end) {
+                rank = Card::Ten;
+                suit++;
+            }
+            int suitIndex = Card::CharToSuit(*suit);
+            if (rank >= 0 && *p != 'X' && *p != 'x' && suitIndex >= 0)
+                StdDeck_CardMask_SET(cards, StdDeck_MAKE_CARD(rank, suitIndex));
+            p = suit + 1;
+        }
+        else {
+            p++;
+        }
+    }
+    return cards;
+}
+
+static int CountCards(StdDeck_CardMask cards)
+{
+    int count = 0;
+    for (int card = 0; card < StdDeck_N_CARDS; card++) {
+        if (StdDeck_CardMask_CARD_IS_SET(cards, card))
+            count++;
+    }
+    return count;
+}
+
+// The player of the given name, or -1
+static int FindPlayer(const HandRecord& hand, const char* name, size_t length)
+{
+    for (int player = 0; player < hand.playerCount; player++) {
+        if (hand.players[player].nameLength == length && memcmp(hand.players[player].name, name, length) == 0)
+            return player;
+    }
+    return -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The player whose name starts the text at p and is followed by separator;
+// the longest such name wins, as one name may be a prefix of another.
+///////////////////////////////////////////////////////////////////////////////
+static int MatchPlayer(const HandRecord& hand, const char* p, const char* end, char separator)
+{
+    int match = -1;
+    for (int player = 0; player < hand.playerCount; player++) {
+        const HandPlayer& hp = hand.players[player];
+        if ((size_t)(end - p) > hp.nameLength && p[hp.nameLength] == separator && memcmp(p, hp.name, hp.nameLength) == 0 &&
+            (match < 0 || hp.nameLength > hand.players[match].nameLength))
+            match = player;
+    }
+    return match;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Game of the header line: Hold'em, Omaha or Omaha Hi/Lo, or -1 for games
+// the library doesn't deal (stud, draw, 5 and 6 card Omaha...).
+///////////////////////////////////////////////////////////////////////////////
+static int ParseGame(const char* p, const char* end)
+{
+    if (Find(p, end, "Hold'em") != NULL)
+        return EquityJob::Holdem;
+
+    if (Find(p, end, "5 Card") != NULL || Find(p, end, "6 Card") != NULL || Find(p, end, "Courchevel") != NULL)
+        return -1;
+
+    if (Find(p, end, "Omaha") != NULL)
+        return Find(p, end, "Hi/Lo") != NULL ? EquityJob::OmahaHiLo : EquityJob::Omaha;
+
+    const char* plo = Find(p, end, "PLO");
+    if (plo != NULL) {
+        plo += 3;
+        if (plo < end && *plo == '-')
+            plo++;
+        if (plo < end && (*plo == '5' || *plo == '6'))
+            return -1;
+        return (plo < end && *plo == '8') || Find(p, end, "Hi/Lo") != NULL ? EquityJob::OmahaHiLo : EquityJob::Omaha;
+    }
+
+    return -1;
+}
+
+HandHistoryParser::HandHistoryParser()
+    : m_pHoldemRanking(NULL), m_pOmahaRanking(NULL), m_skipped(0)
+{
+    m_hand.actions.reserve(64);
+}
+
+HandHistoryParser::~HandHistoryParser()
+{
+}
+
+void HandHistoryParser::SetRanking(const HandRanking* ranking)
+{
+    if (ranking == NULL)
+        return;
+    if (ranking->GetHoleCards() == 2)
+        m_pHoldemRanking = ranking;
+    else
+        m_pOmahaRanking = ranking;
+}
+
+const char* HandHistoryParser::NextLine(const char* p, const char* end)
+{
+    const char* newline = (const char*)memchr(p, '\n', end - p);
+    return newline != NULL ? newline + 1 : end;
+}
+
+const char* HandHistoryParser::NextHand(const char* p, const char* end)
+{
+    while (p < end && HandHeader(p, end) < 0)
+        p = NextLine(p, end);
+    return p;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Hands are split at their header lines and parsed one by one into the same
+// record.
+///////////////////////////////////////////////////////////////////////////////
+int64_t HandHistoryParser::Parse(const char* text, size_t length, HandCallback callback, void* context)
+{
+    const char* end = text + length;
+    int64_t count = 0;
+    m_skipped = 0;
+
+    for (const char* p = NextHand(text, end); p < end; ) {
+        const char* next = NextHand(NextLine(p, end), end);
+        if (!ParseHand(p, next, m_hand)) {
+            m_skipped++;
+        }
+        else {
+            count++;
+            if (!callback(m_hand, context))
+                break;
+        }
+        p = next;
+    }
+
+    return count;
+}
+
+int64_t HandHistoryParser::ParseFile(const char* path, HandCallback callback, void* context)
+{
+    return ParseFile(path, 0, INT64_MAX, callback, context);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The file is mapped MAP_WINDOW bytes at a time, plus MAX_HAND_SIZE so the
+// hands that start in a window end in it too. The next window starts at the
+// first hand that didn't start in this one.
+///////////////////////////////////////////////////////////////////////////////
+int64_t HandHistoryParser::ParseFile(const char* path, int64_t from, int64_t to, HandCallback callback, void* context)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    size_t size = (size_t)st.st_size;
+    size_t stop = (size_t)max((int64_t)0, min(to, (int64_t)size));
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t position = (size_t)max((int64_t)0, from);	// where the next window begins
+    bool synced = (position == 0);		// position is at the start of a line
+    int64_t count = 0;
+    bool stopped = false;
+    m_skipped = 0;
+
+    while (position < stop && !stopped) {
+        // Mid-line, the window starts a byte early to find the next line
+        size_t start = synced ? position : position - 1;
+        size_t offset = start - start % pageSize;
+        size_t length = min(size - offset, MAP_WINDOW + MAX_HAND_SIZE);
+        void* base = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, (off_t)offset);
+        if (base == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        madvise(base, length, MADV_SEQUENTIAL);
+
+        const char* text = (const char*)base;
+        const char* end = text + length;
+        bool last = (offset + length == size);
+        const char* limit = min(last ? end : text + (position - offset) + MAP_WINDOW, text + (stop - offset));
+        if (limit > end)
+            limit = end;
+
+        const char* p = synced ? text + (position - offset) : NextLine(text + (start - offset), end);
+        synced = true;
+        p = NextHand(p, end);
+        if (p == end && !last) {
+            // No hand starts in the window; go on from its limit
+            p = NextLine(limit - 1, end);
+        }
+        while (p < limit) {
+            const char* next = NextHand(NextLine(p, end), end);
+            if (next == end && !last) {
+                // Longer than MAX_HAND_SIZE: not a hand history
+                m_skipped++;
+                p = NextLine(limit - 1, end);
+                break;
+            }
+
+            if (!ParseHand(p, next, m_hand)) {
+                m_skipped++;
+            }
+            else {
+                count++;
+                if (!callback(m_hand, context)) {
+                    stopped = true;
+                    break;
+                }
+            }
+            p = next;
+        }
+
+        position = offset + (p - text);
+        munmap(base, length);
+    }
+
+    close(fd);
+    return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// One pass over the lines of the hand. The sections are told apart by their
+// "*** ... ***" lines; everything before the hole cards is the header, the
+// seats and the blinds.
+///////////////////////////////////////////////////////////////////////////////
+bool HandHistoryParser::ParseHand(const char* begin, const char* end, HandRecord& hand) const
+{
+    int header = HandHeader(begin, end);
+    if (header < 0)
+        return false;
+
+    hand.id = 0;
+    hand.site = HAND_HEADERS[header].site;
+    hand.maxSeats = 0;
+    hand.button = 0;
+    hand.playerCount = 0;
+    hand.boardCards = 0;
+    hand.smallBlind = 0;
+    hand.bigBlind = 0;
+    StdDeck_CardMask_RESET(hand.board);
+    hand.actions.clear();
+    hand.text = begin;
+    hand.length = end - begin;
+
+    // Header: id, game and blinds
+    const char* line = begin;
+    const char* lineEnd = NextLine(line, end);
+    const char* p = (const char*)memchr(line, '#', lineEnd - line) + 1;
+    while (p < lineEnd && !isdigit((unsigned char)*p))
+        p++;
+    for (; p < lineEnd && isdigit((unsigned char)*p); p++)
+        hand.id = hand.id * 10 + (*p - '0');
+
+    int game = ParseGame(line, lineEnd);
+    if (game < 0)
+        return false;
+    hand.game = (uint8_t)game;
+    int holeCards = game == EquityJob::Holdem ? 2 : 4;
+
+    for (p = line; (p = (const char*)memchr(p, '(', lineEnd - p)) != NULL; p++) {
+        const char* slash = ParseAmount(p + 1, lineEnd, hand.smallBlind);
+        if (slash != NULL && *slash == '/' && ParseAmount(slash + 1, lineEnd, hand.bigBlind) != NULL)
+            break;
+        hand.smallBlind = hand.bigBlind = 0;
+    }
+
+    int street = HandRecord::Preflop;
+    bool summary = false;
+    for (line = lineEnd; line < end; line = lineEnd) {
+        lineEnd = NextLine(line, end);
+        const char* e = lineEnd;
+        while (e > line && (e[-1] == '\n' || e[-1] == '\r'))
+            e--;
+        if (e == line)
+            continue;
+
+        if (StartsWith(line, e, "*** ")) {
+            const char* name = line + 4;
+            if (StartsWith(name, e, "FIRST "))
+                name += 6;
+            else if (StartsWith(name, e, "SECOND ") || StartsWith(name, e, "THIRD "))
+                continue;		// the other boards of a run-it-twice hand
+
+            if (StartsWith(name, e, "HOLE CARDS"))
+                street = HandRecord::Preflop;
+            else if (StartsWith(name, e, "FLOP"))
+                street = HandRecord::Flop;
+            else if (StartsWith(name, e, "TURN"))
+                street = HandRecord::Turn;
+            else if (StartsWith(name, e, "RIVER"))
+                street = HandRecord::River;
+            else if (StartsWith(name, e, "SHOW DOWN") || StartsWith(name, e, "SHOWDOWN"))
+                street = HandRecord::Showdown;
+            else if (StartsWith(name, e, "SUMMARY"))
+                summary = true;
+
+            if (street >= HandRecord::Flop && street <= HandRecord::River && !summary)
+                StdDeck_CardMask_OR(hand.board, hand.board, ParseCards(name, e));
+            continue;
+        }
+
+        if (StartsWith(line, e, "Table '")) {
+            const char* quote = (const char*)memchr(line + 7, '\'', e - line - 7);
+            const char* max = quote ? Find(quote, e, "-max") : NULL;
+            if (max != NULL) {
+                const char* digits = max;
+                while (digits > quote && isdigit((unsigned char)digits[-1]))
+                    digits--;
+                hand.maxSeats = (uint8_t)atoi(digits);
+            }
+            const char* button = Find(line, e, "Seat #");
+            if (button != NULL)
+                hand.button = (uint8_t)atoi(button + 6);
+            continue;
+        }
+
+        if (StartsWith(line, e, "Seat ")) {
+            int seat = atoi(line + 5);
+            const char* colon = (const char*)memchr(line, ':', e - line);
+            if (colon == NULL || colon + 2 > e)
+                continue;
+
+            if (summary) {
+                // "Seat 2: name showed [Qs Qh] and won ..." also lists mucked hands
+                int player = hand.FindSeat(seat);
+                const char* cards = Find(colon, e, "showed [");
+                if (cards == NULL)
+                    cards = Find(colon, e, "mucked [");
+                if (player >= 0 && cards != NULL) {
+                    hand.players[player].cards = ParseCards(cards, e);
+                    hand.players[player].flags |= HandPlayer::Shown;
+                }
+                continue;
+            }
+
+            const char* chips = Find(colon, e, " in chips");
+            if (chips == NULL || hand.playerCount == HandRecord::MAX_PLAYERS)
+                continue;
+            const char* paren = chips;
+            while (paren > colon && *paren != '(')
+                paren--;
+            if (paren <= colon + 2)
+                continue;
+
+            HandPlayer& hp = hand.players[hand.playerCount++];
+            hp.name = colon + 2;
+            hp.nameLength = (uint16_t)(paren - 1 - hp.name);
+            hp.seat = (uint8_t)seat;
+            hp.flags = 0;
+            hp.stack = 0;
+            hp.won = 0;
+            StdDeck_CardMask_RESET(hp.cards);
+            hp.handIndex = -1;
+            hp.percentile = -1.0;
+            ParseAmount(paren + 1, chips, hp.stack);
+            continue;
+        }
+
+        if (summary) {
+            if (StartsWith(line, e, "Board ["))
+                hand.board = ParseCards(line + 6, e);
+            continue;
+        }
+
+        if (StartsWith(line, e, "Dealt to ")) {
+            const char* name = line + 9;
+            int player = MatchPlayer(hand, name, e, ' ');
+            if (player >= 0 && memchr(name, '[', e - name) != NULL) {
+                hand.players[player].cards = ParseCards(name + hand.players[player].nameLength, e);
+                hand.players[player].flags |= HandPlayer::Dealt;
+            }
+            continue;
+        }
+
+        if (StartsWith(line, e, "Uncalled bet (")) {
+            const char* to = Find(line, e, ") returned to ");
+            int player = to != NULL ? FindPlayer(hand, to + 14, e - to - 14) : -1;
+            HandAction action = { 0, (uint8_t)street, HandAction::Uncalled, false, 0 };
+            if (player >= 0 && ParseAmount(line + 14, e, action.amount) != NULL) {
+                action.player = (uint8_t)player;
+                hand.actions.push_back(action);
+            }
+            continue;
+        }
+
+        int player = MatchPlayer(hand, line, e, ':');
+        if (player < 0) {
+            player = MatchPlayer(hand, line, e, ' ');
+            const char* collected = player >= 0 ? line + hand.players[player].nameLength : NULL;
+            if (collected != NULL && StartsWith(collected, e, " collected ")) {
+                int64_t amount = 0;
+                if (ParseAmount(collected + 11, e, amount) != NULL) {
+                    hand.players[player].won += amount;
+                    hand.players[player].flags |= HandPlayer::Won;
+                }
+            }
+            continue;
+        }
+
+        const char* verb = line + hand.players[player].nameLength + 2;
+        if (StartsWith(verb, e, "shows [")) {
+            hand.players[player].cards = ParseCards(verb + 6, e);
+            hand.players[player].flags |= HandPlayer::Shown;
+            continue;
+        }
+
+        HandAction action = { (uint8_t)player, (uint8_t)street, HandAction::Post, false, 0 };
+        if (StartsWith(verb, e, "posts "))
+            action.type = HandAction::Post;
+        else if (StartsWith(verb, e, "folds"))
+            action.type = HandAction::Fold;
+        else if (StartsWith(verb, e, "checks"))
+            action.type = HandAction::Check;
+        else if (StartsWith(verb, e, "calls "))
+            action.type = HandAction::Call;
+        else if (StartsWith(verb, e, "bets "))
+            action.type = HandAction::Bet;
+        else if (StartsWith(verb, e, "raises "))
+            action.type = HandAction::Raise;
+        else
+            continue;		// chat, sitting out, mucks...
+
+        if (action.type != HandAction::Fold && action.type != HandAction::Check) {
+            const char* allIn = Find(verb, e, " and is all-in");
+            action.allIn = (allIn != NULL);
+            const char* last = allIn != NULL ? allIn : e;
+            const char* amount = last;
+            while (amount > verb && amount[-1] != ' ')
+                amount--;
+            ParseAmount(amount, last, action.amount);
+        }
+        hand.actions.push_back(action);
+    }
+
+    // The cards that are known, checked against the game, and their ranks
+    hand.boardCards = (uint8_t)CountCards(hand.board);
+    const HandRanking* ranking = holeCards == 2 ? m_pHoldemRanking : m_pOmahaRanking;
+    for (int player = 0; player < hand.playerCount; player++) {
+        HandPlayer& hp = hand.players[player];
+        if (StdDeck_CardMask_IS_EMPTY(hp.cards))
+            continue;
+        hp.handIndex = HandBitset::Index(hp.cards, holeCards);
+        if (hp.handIndex < 0) {
+            StdDeck_CardMask_RESET(hp.cards);
+            hp.flags &= ~(HandPlayer::Dealt | HandPlayer::Shown);
+        }
+        else if (ranking != NULL) {
+            hp.percentile = ranking->GetPercentile(hp.handIndex);
+        }
+    }
+
+    return hand.playerCount > 0;
+}
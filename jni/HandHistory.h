@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+class HandRanking;
+
+///////////////////////////////////////////////////////////////////////////////
+// One hand of a hand history, as compact as the parser can make it. Names
+// point into the text being parsed, so a record is only valid during the
+// callback it is passed to. Amounts are in hundredths (cents, or hundredths
+// of a chip in tournaments).
+///////////////////////////////////////////////////////////////////////////////
+struct HandAction
+{
+	enum Type
+	{
+		Post,			// blinds and antes
+		Fold,
+		Check,
+		Call,
+		Bet,
+		Raise,			// amount is the total raised to
+		Uncalled		// uncalled bet returned
+	};
+
+	uint8_t player;		// index into HandRecord::players
+	uint8_t street;		// HandRecord::Street
+	uint8_t type;
+	bool allIn;
+	int64_t amount;
+};
+
+struct HandPlayer
+{
+	enum Flags
+	{
+		Dealt = 1,		// hole cards known from "Dealt to"
+		Shown = 2,		// hole cards shown or mucked face up
+		Won = 4			// collected (part of) a pot
+	};
+
+	const char* name;
+	uint16_t nameLength;
+	uint8_t seat;
+	uint8_t flags;
+	int64_t stack;
+	int64_t won;
+	StdDeck_CardMask cards;		// empty when unknown
+	int handIndex;				// HandBitset::Index() of the cards, or -1
+	double percentile;			// HandRanking::GetPercentile(), or -1
+};
+
+struct HandRecord
+{
+	enum Site
+	{
+		PokerStars,
+		GGPoker
+	};
+
+	enum Street
+	{
+		Preflop,
+		Flop,
+		Turn,
+		River,
+		Showdown
+	};
+
+	static const int MAX_PLAYERS = 10;
+
+	uint64_t id;
+	uint8_t site;
+	uint8_t game;				// EquityJob::Game
+	uint8_t maxSeats;			// 0 when the table line doesn't say
+	uint8_t button;				// seat number of the button
+	uint8_t playerCount;
+	uint8_t boardCards;
+	int64_t smallBlind;
+	int64_t bigBlind;
+	StdDeck_CardMask board;
+	HandPlayer players[MAX_PLAYERS];
+	vector<HandAction> actions;
+
+	const char* text;			// the hand's text
+	size_t length;
+
+	int FindSeat(int seat) const;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Streaming parser for PokerStars and GGPoker hand history text exports
+// (Hold'em, Omaha and Omaha Hi/Lo; cash games and tournaments). Files are
+// mapped read-only a window at a time, so files of any size parse in a
+// small, fixed amount of address space and nothing is copied: each hand is
+// parsed in place into a reused HandRecord and handed to the callback.
+//
+//		HandHistoryParser parser;
+//		parser.SetRanking(HandRanking::Get(OrderingTables::DefaultHoldem(), 2));
+//		parser.ParseFile("HH20240101.txt", OnHand, context);
+//
+// Shown hands get their HandBitset index and, with a ranking, their
+// percentile as they are parsed. Hands of other games (stud, draw, 5 card
+// Omaha) and hands that can't be parsed are skipped and counted.
+///////////////////////////////////////////////////////////////////////////////
+class HandHistoryParser
+{
+public:
+	// Return false to stop parsing.
+	typedef bool (*HandCallback)(const HandRecord& hand, void* context);
+
+	HandHistoryParser();
+	~HandHistoryParser();
+
+	// Rankings used for the percentiles of Hold'em and Omaha hands; either
+	// may be NULL (the default), leaving those percentiles at -1.
+	void SetRanking(const HandRanking* ranking);
+
+	// Parse every hand of a file or of text in memory. Returns the number of
+	// hands passed to the callback, or -1 if the file could not be read.
+	int64_t ParseFile(const char* path, HandCallback callback, void* context);
+	int64_t Parse(const char* text, size_t length, HandCallback callback, void* context);
+
+	// Parse the hands of a file whose first line starts at a byte offset in
+	// [from, to). from need not be at the start of a hand, so a file can be
+	// cut anywhere into pieces that together parse every hand once.
+	int64_t ParseFile(const char* path, int64_t from, int64_t to, HandCallback callback, void* context);
+
+	// Parse the one hand in [begin, end) into hand. Returns false if it
+	// isn't a hand of a supported game or could not be parsed.
+	bool ParseHand(const char* begin, const char* end, HandRecord& hand) const;
+
+	// Hands skipped by the last ParseFile() or Parse().
+	int64_t GetSkipped() const { return m_skipped; }
+
+	// Start of the first hand that starts at or after p, or end. p must be
+	// at the start of a line.
+	static const char* NextHand(const char* p, const char* end);
+
+	// Start of the line after the one p is in, or end.
+	static const char* NextLine(const char* p, const char* end);
+
+	// Largest hand a file window is guaranteed to hold in one piece.
+	static const size_t MAX_HAND_SIZE = 1 << 20;
+
+private:
+	const HandRanking* m_pHoldemRanking;
+	const HandRanking* m_pOmahaRanking;
+	int64_t m_skipped;
+	HandRecord m_hand;
+};
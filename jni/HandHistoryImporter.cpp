@@ -0,0 +1,360 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <sys/stat.h>
+#include <deque>
+#include <thread>
+#include <system_error>
+#include <unordered_map>
+#include <inlines/eval.h>
+#include "HandDistributions.h"
+#include "HandHistoryImporter.h"
+#include "HandHistory.h"
+#include "HandRanking.h"
+#include "OrderingTables.h"
+#include "EquityJob.h"
+
+const int64_t HandHistoryImporter::DEFAULT_SHARD_SIZE;
+const int64_t HandHistoryImporter::MIN_SHARD_SIZE;
+
+// The hands of a file whose header lines start in [from, to)
+struct HandHistoryImporter::Shard
+{
+    const char* path;
+    int64_t from;
+    int64_t to;
+};
+
+// The aggregates of one shard, kept until every shard before it is merged
+struct HandHistoryImporter::ShardResult
+{
+    const HandRanking* pHoldemRanking;
+    const HandRanking* pOmahaRanking;
+    unordered_map<string, HandHistoryPlayerStats> players;
+    string key;			// scratch for the lookups
+    int64_t hands;
+    int64_t skipped;
+    bool failed;
+};
+
+// A worker's shards: it takes them from the front, thieves from the back
+struct HandHistoryImporter::Queue
+{
+    mutex lock;
+    deque<int> shards;
+};
+
+// Players are keyed by site and game, then name
+static void MakeKey(string& key, int site, int game, const char* name, size_t length)
+{
+    key.clear();
+    key += (char)site;
+    key += (char)game;
+    key.append(name, length);
+}
+
+void HandHistoryPlayerStats::Merge(const HandHistoryPlayerStats& other)
+{
+    hands += other.hands;
+    vpip += other.vpip;
+    showdowns += other.showdowns;
+    positionSum += other.positionSum;
+    classes = max(classes, other.classes);
+    for (int i = 0; i < PERCENTILE_BUCKETS; i++)
+        percentiles[i] += other.percentiles[i];
+
+    if (!other.heatmapHands.empty()) {
+        if (heatmapHands.empty()) {
+            heatmapHands.assign(HEATMAP_CELLS, 0);
+            heatmapVpip.assign(HEATMAP_CELLS, 0);
+        }
+        for (int i = 0; i < HEATMAP_CELLS; i++) {
+            heatmapHands[i] += other.heatmapHands[i];
+            heatmapVpip[i] += other.heatmapVpip[i];
+        }
+    }
+}
+
+HandHistoryImporter::HandHistoryImporter()
+    : m_pHoldemRanking(NULL), m_pOmahaRanking(NULL), m_shardSize(DEFAULT_SHARD_SIZE),
+      m_hands(0), m_skipped(0), m_failed(false), m_nextMerge(0), m_mergeWindow(0), m_abort(false)
+{
+}
+
+HandHistoryImporter::~HandHistoryImporter()
+{
+}
+
+void HandHistoryImporter::SetRanking(const HandRanking* ranking)
+{
+    if (ranking == NULL)
+        return;
+    if (ranking->GetHoleCards() == 2)
+        m_pHoldemRanking = ranking;
+    else
+        m_pOmahaRanking = ranking;
+}
+
+void HandHistoryImporter::Clear()
+{
+    m_players.clear();
+    m_hands = 0;
+    m_skipped = 0;
+}
+
+int64_t HandHistoryImporter::Import(const vector<string>& paths, int threads)
+{
+    if (m_pHoldemRanking == NULL)
+        m_pHoldemRanking = HandRanking::Get(OrderingTables::DefaultHoldem(), 2);
+    if (m_pOmahaRanking == NULL)
+        m_pOmahaRanking = HandRanking::Get(OrderingTables::DefaultOmaha(), 4);
+    if (threads < 1)
+        threads = EquityJob::GetDefaultThreads();
+
+    // Cut the files into shards, in order
+    vector<Shard> shards;
+    m_failed = false;
+    for (size_t i = 0; i < paths.size(); i++) {
+        struct stat st;
+        if (stat(paths[i].c_str(), &st) != 0) {
+            m_failed = true;
+            continue;
+        }
+        for (int64_t from = 0; from < (int64_t)st.st_size; from += m_shardSize) {
+            Shard shard = { paths[i].c_str(), from, min(from + m_shardSize, (int64_t)st.st_size) };
+            shards.push_back(shard);
+        }
+    }
+    if (shards.empty())
+        return m_failed ? -1 : 0;
+
+    // The shards are dealt out in turn, so the workers move through the
+    // files together and few shard results wait for an earlier one
+    threads = (int)min((size_t)threads, shards.size());
+    vector<Queue> queues(threads);
+    for (size_t i = 0; i < shards.size(); i++)
+        queues[i % threads].shards.push_back((int)i);
+
+    int64_t hands = m_hands;
+    vector<ShardResult*> results(shards.size(), NULL);
+    m_nextMerge = 0;
+    m_mergeWindow = 2 * threads;
+    m_abort = false;
+
+    // A worker that can't be started fails the import: the queues are
+    // emptied, so the workers that did start stop after their current shard
+    vector<thread> workers;
+    workers.reserve(threads);
+    bool started = true;
+    try {
+        for (int worker = 1; worker < threads; worker++)
+            workers.push_back(thread(&HandHistoryImporter::Run, this, worker, ref(queues), cref(shards), ref(results)));
+    }
+    catch (std::system_error&) {
+        started = false;
+        for (int worker = 0; worker < threads; worker++) {
+            lock_guard<mutex> lock(queues[worker].lock);
+            queues[worker].shards.clear();
+        }
+        lock_guard<mutex> lock(m_lock);
+        m_abort = true;
+        m_merged.notify_all();
+    }
+    if (started)
+        Run(0, queues, shards, results);
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    if (!started) {
+        // Shards finished after one that never ran were not merged
+        for (size_t i = 0; i < results.size(); i++)
+            delete results[i];
+        m_failed = true;
+    }
+
+    return m_failed ? -1 : m_hands - hands;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// A worker parses its own shards from the front of its queue, then steals
+// from the back of the others' until there is nothing left.
+///////////////////////////////////////////////////////////////////////////////
+void HandHistoryImporter::Run(int worker, vector<Queue>& queues, const vector<Shard>& shards, vector<ShardResult*>& results)
+{
+    HandHistoryParser parser;
+    parser.SetRanking(m_pHoldemRanking);
+    parser.SetRanking(m_pOmahaRanking);
+
+    int threads = (int)queues.size();
+    for (;;) {
+        int index = -1;
+        for (int i = 0; i < threads && index < 0; i++) {
+            Queue& queue = queues[(worker + i) % threads];
+            lock_guard<mutex> lock(queue.lock);
+            if (queue.shards.empty())
+                continue;
+            if (i == 0) {
+                index = queue.shards.front();
+                queue.shards.pop_front();
+            }
+            else {
+                index = queue.shards.back();
+                queue.shards.pop_back();
+            }
+        }
+        if (index < 0)
+            break;
+
+        // A worker that gets too far ahead of the merge (on one core, time
+        // slices are long) waits, so that the results of the shards after
+        // one still being parsed don't pile up. The shard next in line to be
+        // merged never waits.
+        {
+            unique_lock<mutex> lock(m_lock);
+            while (!m_abort && (size_t)index >= m_nextMerge + m_mergeWindow)
+                m_merged.wait(lock);
+            if (m_abort)
+                break;
+        }
+
+        const Shard& shard = shards[index];
+        ShardResult* result = new ShardResult;
+        result->pHoldemRanking = m_pHoldemRanking;
+        result->pOmahaRanking = m_pOmahaRanking;
+        int64_t count = parser.ParseFile(shard.path, shard.from, shard.to, AddHand, result);
+        result->hands = max((int64_t)0, count);
+        result->skipped = parser.GetSkipped();
+        result->failed = (count < 0);
+
+        lock_guard<mutex> lock(m_lock);
+        results[index] = result;
+        MergeReady(results);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Merge the finished shards that follow the last merged one, and wake the
+// workers waiting for the merge to catch up. Called with m_lock held.
+///////////////////////////////////////////////////////////////////////////////
+void HandHistoryImporter::MergeReady(vector<ShardResult*>& results)
+{
+    size_t first = m_nextMerge;
+    while (m_nextMerge < results.size() && results[m_nextMerge] != NULL) {
+        ShardResult* result = results[m_nextMerge];
+
+        // A player's totals only depend on the order of the shards
+        for (auto it = result->players.begin(); it != result->players.end(); ++it) {
+            auto merged = m_players.find(it->first);
+            if (merged == m_players.end())
+                m_players.insert(*it);
+            else
+                merged->second.Merge(it->second);
+        }
+
+        m_hands += result->hands;
+        m_skipped += result->skipped;
+        m_failed = m_failed || result->failed;
+        delete result;
+        results[m_nextMerge++] = NULL;
+    }
+
+    if (m_nextMerge != first)
+        m_merged.notify_all();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Parser callback: add one hand to its shard's aggregates.
+///////////////////////////////////////////////////////////////////////////////
+bool HandHistoryImporter::AddHand(const HandRecord& hand, void* context)
+{
+    ShardResult* result = (ShardResult*)context;
+    const HandRanking* ranking = hand.game == EquityJob::Holdem ? result->pHoldemRanking : result->pOmahaRanking;
+    int size = ranking != NULL ? ranking->GetTable()->GetSize() : 0;
+
+    bool played[HandRecord::MAX_PLAYERS] = { false };
+    bool voluntary[HandRecord::MAX_PLAYERS] = { false };
+    for (size_t i = 0; i < hand.actions.size(); i++) {
+        const HandAction& action = hand.actions[i];
+        played[action.player] = true;
+        if (action.street == HandRecord::Preflop &&
+            (action.type == HandAction::Call || action.type == HandAction::Bet || action.type == HandAction::Raise))
+            voluntary[action.player] = true;
+    }
+
+    for (int i = 0; i < hand.playerCount; i++) {
+        const HandPlayer& player = hand.players[i];
+        if (!played[i] && player.flags == 0)
+            continue;
+
+        MakeKey(result->key, hand.site, hand.game, player.name, player.nameLength);
+        HandHistoryPlayerStats& stats = result->players[result->key];
+        if (stats.name.empty()) {
+            stats.name.assign(player.name, player.nameLength);
+            stats.site = hand.site;
+            stats.game = hand.game;
+            stats.hands = stats.vpip = stats.showdowns = stats.positionSum = 0;
+            stats.classes = size;
+            memset(stats.percentiles, 0, sizeof(stats.percentiles));
+        }
+
+        stats.hands++;
+        if (voluntary[i])
+            stats.vpip++;
+
+        int position = (size > 0 && player.handIndex >= 0) ? ranking->GetPosition(player.handIndex) : -1;
+        if (position < 0)
+            continue;
+
+        if (player.flags & HandPlayer::Shown) {
+            stats.showdowns++;
+            stats.positionSum += position + 1;
+            stats.percentiles[(int64_t)position * HandHistoryPlayerStats::PERCENTILE_BUCKETS / size]++;
+        }
+
+        if (stats.heatmapHands.empty()) {
+            stats.heatmapHands.assign(HandHistoryPlayerStats::HEATMAP_CELLS, 0);
+            stats.heatmapVpip.assign(HandHistoryPlayerStats::HEATMAP_CELLS, 0);
+        }
+        int cell = (int)((int64_t)position * HandHistoryPlayerStats::HEATMAP_CELLS / size);
+        stats.heatmapHands[cell]++;
+        if (voluntary[i])
+            stats.heatmapVpip[cell]++;
+    }
+
+    return true;
+}
+
+vector<HandHistoryPlayerStats> HandHistoryImporter::GetPlayers() const
+{
+    vector<HandHistoryPlayerStats> players;
+    players.reserve(m_players.size());
+    for (auto it = m_players.begin(); it != m_players.end(); ++it)
+        players.push_back(it->second);
+    return players;
+}
+
+const HandHistoryPlayerStats* HandHistoryImporter::Find(int site, int game, const char* name) const
+{
+    string key;
+    MakeKey(key, site, game, name, strlen(name));
+    auto it = m_players.find(key);
+    return it != m_players.end() ? &it->second : NULL;
+}
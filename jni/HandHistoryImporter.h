@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <map>
+#include <condition_variable>
+
+class HandRanking;
+struct HandRecord;
+
+///////////////////////////////////////////////////////////////////////////////
+// What the hands of an import say about one player in one game. Hands are
+// placed by their class's position in the game's ordering table: the
+// percentile buckets are 5% slices of the table, and the heatmap has one cell
+// per Hold'em class (HandRanking::GetTable()->Get(cell) names it) or, for
+// Omaha, per 1/169th of the table.
+///////////////////////////////////////////////////////////////////////////////
+struct HandHistoryPlayerStats
+{
+	static const int PERCENTILE_BUCKETS = 20;
+	static const int HEATMAP_CELLS = 169;
+
+	string name;
+	uint8_t site;					// HandRecord::Site
+	uint8_t game;					// EquityJob::Game
+
+	int64_t hands;					// hands played (anything but sitting out)
+	int64_t vpip;					// hands with a preflop call, bet or raise
+	int64_t showdowns;				// hands shown with a ranked class
+	int64_t positionSum;			// of the hands shown, counting from 1
+	int classes;					// size of the ordering table
+	int64_t percentiles[PERCENTILE_BUCKETS];	// hands shown, by bucket
+
+	// Hands whose cards are known (shown, or dealt to the player) and how
+	// many of them were played, by cell. Empty until the first known hand.
+	vector<uint32_t> heatmapHands;
+	vector<uint32_t> heatmapVpip;
+
+	double GetMeanPercentile() const { return showdowns > 0 ? 100.0 * positionSum / showdowns / classes : -1.0; }
+
+	void Merge(const HandHistoryPlayerStats& other);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Imports hand history files on a pool of threads. Every file is cut into
+// shards of about SetShardSize() bytes; a shard owns the hands whose header
+// line starts in it, so shards split the files at hand boundaries without
+// reading them first. The shards are dealt to the workers in turn; a worker
+// that runs out steals from the far end of another worker's queue.
+//
+// Every shard is aggregated on its own and the shard aggregates are merged
+// in file and shard order as they finish. The workers move through the
+// shards together, and one that gets more than two shards per worker ahead
+// of the merge waits for it, so only a few aggregates are held at a time.
+// The aggregates are all integers, so the results don't depend on the shard
+// size, the number of threads or which thread ran which shard.
+//
+//		HandHistoryImporter importer;
+//		vector<string> files(1, "HH20240101.txt");
+//		importer.Import(files, 0);
+//		for (auto& player : importer.GetPlayers())
+//			printf("%s %.1f\n", player.name.c_str(), player.GetMeanPercentile());
+///////////////////////////////////////////////////////////////////////////////
+class HandHistoryImporter
+{
+public:
+	static const int64_t DEFAULT_SHARD_SIZE = 16 << 20;
+	static const int64_t MIN_SHARD_SIZE = 1 << 16;
+
+	HandHistoryImporter();
+	~HandHistoryImporter();
+
+	// As HandHistoryParser::SetRanking(). Rankings left unset are those of
+	// the default Hold'em and Omaha ordering tables.
+	void SetRanking(const HandRanking* ranking);
+	void SetShardSize(int64_t bytes) { m_shardSize = max(MIN_SHARD_SIZE, bytes); }
+
+	// Import the files on threads threads (0: one per big core), adding to
+	// the results of earlier imports. Returns the number of hands imported,
+	// or -1 if a file could not be read (hands of the files that could are
+	// still counted in the results) or a worker thread could not be started
+	// (the import then stops with part of the hands counted).
+	int64_t Import(const vector<string>& paths, int threads);
+
+	// Players sorted by site, game and name.
+	vector<HandHistoryPlayerStats> GetPlayers() const;
+	const HandHistoryPlayerStats* Find(int site, int game, const char* name) const;
+
+	int64_t GetHands() const { return m_hands; }
+	int64_t GetSkipped() const { return m_skipped; }
+
+	void Clear();
+
+private:
+	struct Shard;
+	struct ShardResult;
+	struct Queue;
+
+	void Run(int worker, vector<Queue>& queues, const vector<Shard>& shards, vector<ShardResult*>& results);
+	static bool AddHand(const HandRecord& hand, void* context);
+	void MergeReady(vector<ShardResult*>& results);
+
+	const HandRanking* m_pHoldemRanking;
+	const HandRanking* m_pOmahaRanking;
+	int64_t m_shardSize;
+
+	// Merged results, keyed by site, game and name
+	map<string, HandHistoryPlayerStats> m_players;
+	int64_t m_hands;
+	int64_t m_skipped;
+	bool m_failed;
+
+	mutex m_lock;			// guards the merge
+	condition_variable m_merged;	// signalled when shards are merged
+	size_t m_nextMerge;		// first shard not merged yet
+	size_t m_mergeWindow;	// shards a worker may start past m_nextMerge
+	bool m_abort;			// a worker could not be started
+};
@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <inlines/eval_omaha.h>
+#include "HandDistributions.h"
+#include "HandRanking.h"
+#include "HandBitset.h"
+#include "OrderingTables.h"
+#include "HoldemAgnosticHand.h"
+#include "OmahaAgnosticHand.h"
+
+static mutex s_rankingsLock;
+static vector<const HandRanking*> s_rankings;
+
+const HandRanking* HandRanking::Get(const OrderingTable* table, int holeCards)
+{
+    if (table == NULL || (holeCards != 2 && holeCards != 4))
+        return NULL;
+
+    lock_guard<mutex> lock(s_rankingsLock);
+    for (size_t i = 0; i < s_rankings.size(); i++) {
+        if (s_rankings[i]->m_pTable == table && s_rankings[i]->m_holeCards == holeCards)
+            return s_rankings[i];
+    }
+
+    HandRanking* ranking = new HandRanking(table, holeCards);
+    s_rankings.push_back(ranking);
+    return ranking;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Classes are instantiated strongest first, so a hand that more than one
+// class holds keeps the best position, as in a percent range.
+///////////////////////////////////////////////////////////////////////////////
+HandRanking::HandRanking(const OrderingTable* table, int holeCards)
+    : m_pTable(table), m_holeCards(holeCards), m_positions(HandBitset::SizeOf(holeCards), -1)
+{
+    StdDeck_CardMask dead;
+    StdDeck_CardMask_RESET(dead);
+
+    vector<StdDeck_CardMask> hands;
+    for (int position = 0; position < table->GetSize(); position++) {
+        const char* entry = table->Get(position);
+        hands.clear();
+        if (holeCards == 2) {
+            HoldemAgnosticHand hand(table);
+            if (HoldemAgnosticHand::Parse(entry, dead))
+                hand.Instantiate(entry, dead, hands);
+        }
+        else {
+            OmahaAgnosticHand hand(table);
+            if (hand.Parse(entry, dead))
+                hand.Instantiate(entry, dead, hands);
+        }
+
+        for (size_t i = 0; i < hands.size(); i++) {
+            int index = HandBitset::Index(hands[i], holeCards);
+            if (index >= 0 && m_positions[index] < 0)
+                m_positions[index] = position;
+        }
+    }
+}
+
+int HandRanking::GetPosition(StdDeck_CardMask hand) const
+{
+    return GetPosition(HandBitset::Index(hand, m_holeCards));
+}
+
+double HandRanking::GetPercentile(StdDeck_CardMask hand) const
+{
+    int position = GetPosition(hand);
+    return position < 0 ? -1.0 : 100.0 * (position + 1) / m_pTable->GetSize();
+}
+
+double HandRanking::GetPercentile(int handIndex) const
+{
+    int position = GetPosition(handIndex);
+    return position < 0 ? -1.0 : 100.0 * (position + 1) / m_pTable->GetSize();
+}
@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+class OrderingTable;
+
+///////////////////////////////////////////////////////////////////////////////
+// The position of every specific hand in an ordering table, looked up by
+// HandBitset::Index(): the reverse of resolving a percent range. A hand at
+// position i of a table of N classes is in every slice "p%" with
+// p > 100 * (i + 1) / N, which is its percentile.
+//
+// Building a ranking instantiates every class of the table once (a few
+// hundred milliseconds for Omaha), so rankings are built on first use and
+// shared: Get() returns the same immutable ranking to every caller.
+///////////////////////////////////////////////////////////////////////////////
+class HandRanking
+{
+public:
+	// Ranking of the hands of holeCards cards (2 or 4) in table, or NULL if
+	// there is no table.
+	static const HandRanking* Get(const OrderingTable* table, int holeCards);
+
+	const OrderingTable* GetTable() const { return m_pTable; }
+	int GetHoleCards() const { return m_holeCards; }
+
+	// Position of the hand's class in the table, or -1 if the table has no
+	// class holding the hand.
+	int GetPosition(StdDeck_CardMask hand) const;
+	int GetPosition(int handIndex) const { return (size_t)handIndex < m_positions.size() ? m_positions[handIndex] : -1; }
+
+	// Percentile of the hand (0 < percentile <= 100, lower is stronger), or
+	// -1 if the table has no class holding it.
+	double GetPercentile(StdDeck_CardMask hand) const;
+	double GetPercentile(int handIndex) const;
+
+private:
+	HandRanking(const OrderingTable* table, int holeCards);
+
+	const OrderingTable* m_pTable;
+	int m_holeCards;
+	vector<int> m_positions;		// by HandBitset::Index()
+};
@@ -17,20 +17,31 @@
 // relying on it. The user must assume the entire risk of using the source code.
 //
 ///////////////////////////////////////////////////////////////////////////////
-#include <android/log.h>
 #include <inlines/eval.h>
 #include "HandDistributions.h"
 #include "HoldemAgnosticHand.h"
+#include "CardConverter.h"
 #include "Card.h"
-#include "he10maxordering.h"
-#include "he6maxordering.h"
+#include "OrderingTables.h"
+#include "HandDistMetrics.h"
+#include "ParseError.h"
 
-#define  LOG_TAG    "OmahaEqCalc"
-#define  LOGI(...)  __android_log_print(ANDROID_LOG_INFO,LOG_TAG,__VA_ARGS__)
-#define  LOGE(...)  __android_log_print(ANDROID_LOG_ERROR,LOG_TAG,__VA_ARGS__)
+// What each position of a class or range accepts, for ParseError::expected
+static const char* const EXPECT_RANK = "a rank (AKQJT98765432 or X)";
+static const char* const EXPECT_RANGE_RANK = "a rank (AKQJT98765432)";
+static const char* const EXPECT_MODIFIER = "s, o, + or -";
 
 const char **HoldemOrdering = NULL;
 
+///////////////////////////////////////////////////////////////////////////////
+// Percent ranges ("15%", "10-25%") are resolved against the given ordering
+// table, or against OrderingTables::DefaultHoldem() if none is given.
+///////////////////////////////////////////////////////////////////////////////
+HoldemAgnosticHand::HoldemAgnosticHand(const OrderingTable* ordering)
+    : m_ordering(ordering), m_isPercent(false), m_lowerBound(0.0), m_upperBound(0.0)
+{
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Take a given agnostic hand, such as "AA" or "QJs+" or "TT-77", along with
 // an optional collection of "dead" cards, and boil it down into its constituent
@@ -41,26 +52,17 @@ const char **HoldemOrdering = NULL;
 //
 // This version calls the other version of Instantiate internally.
 ///////////////////////////////////////////////////////////////////////////////
-int HoldemAgnosticHand::Parse(const char* handText, const char* deadText)
+int HoldemAgnosticHand::Parse(const char* handText, const char* deadText, ParseError* error)
 {
+    // Malformed dead cards fail the parse
     StdDeck_CardMask deadCards;
-    StdDeck_CardMask_RESET(deadCards);
-		
-    int len = deadText ? strlen(deadText) : 0;
-    if (len > 0) {
-        int suit, rank;
-        StdDeck_CardMask hand;
-        const char* pCard = deadText;
-        for(int i=0; i < len && *pCard != '\0'; i+=2) {
-            rank = Card::CharToRank(*pCard);
-            suit = Card::CharToSuit(*(pCard+1));
-            hand = StdDeck_MASK( StdDeck_MAKE_CARD(rank, suit) );
-            StdDeck_CardMask_OR(deadCards, deadCards, hand);
-            pCard += 2;
-        }
+    if (CardConverter::TextToPokerEval(deadText, deadCards) < 0) {
+        if (error != NULL)
+            error->Set(ParseError::BadDeadCards, 0, "cards such as AhKd");
+        return 0;
     }
 
-    return Parse(handText, deadCards);
+    return Parse(handText, deadCards, error);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -69,10 +71,12 @@ int HoldemAgnosticHand::Parse(const char* handText, const char* deadText)
 // specific Hold'em hands, storing these in the 'specificHands' vector passed
 // in by the client.
 //
-// Returns true of syntax is correct.
+// Returns true of syntax is correct. Otherwise, if error isn't NULL, it gets
+// what is wrong and where; nothing is printed.
 ///////////////////////////////////////////////////////////////////////////////
-int HoldemAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
+int HoldemAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards, ParseError* error)
 {
+    HANDDIST_TIMER(parseTimer, ParseTime);
     if (strcmp(handText, "XxXx") == 0) {
         return 1;
     }
@@ -86,11 +90,11 @@ int HoldemAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
         return 1; // valid
     }
 
-    char *newstr = strdup(handText);
-    const char *p = newstr;
+    const char *p = handText;
     bool suitOffsuit = false;
-    bool isPair = false;
     int seenCards = 0;
+    ParseError::Code code = ParseError::UnexpectedChar;
+    const char* expected = EXPECT_RANK;
 
     while (*p != '\0' && seenCards < 2) {
         if (NULL != strchr("23456789TtJjQqKkAaXx", *p)) {
@@ -124,17 +128,21 @@ int HoldemAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                                         p++; while (*p == ' ') p++;
                                     }
                                     else {
-                                        LOGE("%d: Unexpected %c, at %s %d", __LINE__, *p, p, p-handText-1); 
+                                        expected = "the end of the range";
                                         goto error;
                                     }
                                 }
                             }
                         }
                         else {
-                            LOGE("%d: Unexpected %c, at %s %d", __LINE__, *p, p, p-handText-1); 
+                            expected = EXPECT_RANGE_RANK;
                             goto error;
                         }
                     }
+                    else {
+                        expected = EXPECT_RANGE_RANK;
+                        goto error;
+                    }
                 }
                 else if (*p == '\0') {
                     seenCards++;
@@ -142,12 +150,11 @@ int HoldemAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                     continue;
                 }
                 else {
-                    LOGE("%d: Unexpected %c, at %s %d", __LINE__, *p, p, p-handText-1); 
+                    expected = EXPECT_MODIFIER;
                     goto error;
                 }
             }
             else {
-                LOGE("%d: Unexpected %c, at %s %d", __LINE__, *p, p, p-handText-1); 
                 goto error;
             }
         }
@@ -157,21 +164,33 @@ int HoldemAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
     }
   
     if (seenCards != 2) {
-        LOGE("Only saw %d cards in %s\n", seenCards, handText);
+        code = ParseError::MissingCards;
         goto error;
     }
     if (*p != '\0') {
-        LOGE("Unexpected %s at end of %s\n", p, handText);
+        code = ParseError::ExtraChars;
+        expected = "the end of the hand";
         goto error;
     }
 
     return 1;
   error:
-    if (newstr) free(newstr);
+    if (error != NULL)
+        error->Set(*p == '\0' ? ParseError::MissingCards : code, (int)(p - handText), expected);
     return 0;
 }
 
 char *HoldemAgnosticHand::GetEqvClasses(const char* handText)
+{
+    return GetEqvClasses(handText, NULL);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Return a malloc'd, comma separated list of the hand classes ("AKs,AQs,...")
+// that make up the given agnostic hand. Percent ranges are expanded using the
+// given ordering table (or the default Hold'em table when NULL).
+///////////////////////////////////////////////////////////////////////////////
+char *HoldemAgnosticHand::GetEqvClasses(const char* handText, const OrderingTable* ordering)
 {
 	char *eqvClasses = NULL;
 	if (IsRandomHand(handText)) {
@@ -180,17 +199,21 @@ char *HoldemAgnosticHand::GetEqvClasses(const char* handText)
 
 	double low, high;
 	if (IsPercentRange(handText, low, high)) {
-        int size = sizeof(HOLDEM_10_MAX_ORDERING)/sizeof(const char *);
-        int count = 0;
-        for (int i=low; i < high && i < size; i++) {
+        const OrderingTable* table = ordering ? ordering : OrderingTables::DefaultHoldem();
+        if (table == NULL)
+            return NULL;
+        int first, last;
+        table->Slice(low, high, first, last);
+        for (int i=first; i < last; i++) {
+        	const char* entry = table->Get(i);
         	if (eqvClasses == NULL) {
-        		eqvClasses = (char *)malloc(strlen(HoldemOrdering[i])+1);
-        		strcpy(eqvClasses, HoldemOrdering[i]);
+        		eqvClasses = (char *)malloc(strlen(entry)+1);
+        		strcpy(eqvClasses, entry);
         	}
         	else {
-        		eqvClasses = (char *)realloc(eqvClasses, strlen(eqvClasses)+strlen(HoldemOrdering[i])+2);
+        		eqvClasses = (char *)realloc(eqvClasses, strlen(eqvClasses)+strlen(entry)+2);
         		eqvClasses = strcat(eqvClasses, ",");
-        		eqvClasses = strcat(eqvClasses,  HoldemOrdering[i]);
+        		eqvClasses = strcat(eqvClasses, entry);
         	}
 	    }
 
@@ -324,21 +347,10 @@ char *HoldemAgnosticHand::GetEqvClasses(const char* handText)
 
 int HoldemAgnosticHand::Instantiate(const char* handText, const char* deadText, vector<StdDeck_CardMask>& specificHands)
 {
+    // Malformed dead cards match no hands
     StdDeck_CardMask deadCards;
-    StdDeck_CardMask_RESET(deadCards);
-		
-    if (deadText && strlen(deadText))
-    {
-        int suit, rank;
-        StdDeck_CardMask hand;
-        for(const char* pCard = deadText; pCard != NULL; pCard += 2)
-        {
-            rank = Card::CharToRank(*pCard);
-            suit = Card::CharToSuit(*(pCard+1));
-            hand = StdDeck_MASK( StdDeck_MAKE_CARD(rank, suit) );
-            StdDeck_CardMask_OR(deadCards, deadCards, hand);
-        }
-    }
+    if (CardConverter::TextToPokerEval(deadText, deadCards) < 0)
+        return 0;
 
     return Instantiate(handText, deadCards, specificHands);
 }
@@ -366,6 +378,7 @@ int HoldemAgnosticHand::Instantiate(const char* handText, StdDeck_CardMask deadC
         return specificHands.size();
     }
 
+    HANDDIST_TIMER(classTimer, InstantiateClassTime);
     bool isPlus = (NULL != strchr(handText, '+'));
     bool isSlice = (NULL != strchr(handText, '-'));
     int handRanks[2] = {0,0};
@@ -525,6 +538,7 @@ int HoldemAgnosticHand::Instantiate(const char* handText, StdDeck_CardMask deadC
 ///////////////////////////////////////////////////////////////////////////////
 int HoldemAgnosticHand::InstantiateRandom(StdDeck_CardMask deadCards, vector<StdDeck_CardMask>& specificHands)
 {
+    HANDDIST_TIMER(randomTimer, InstantiateRandomTime);
     StdDeck_CardMask curHand;
     DECK_ENUMERATE_2_CARDS_D(StdDeck, curHand, deadCards, specificHands.push_back(curHand); );
     return specificHands.size();
@@ -663,14 +677,18 @@ bool HoldemAgnosticHand::IsRandomHand(const char *handText)
 
 int HoldemAgnosticHand::InstantiatePercentRange(const char* handText, StdDeck_CardMask deadCards, vector<StdDeck_CardMask>& specificHands)
 {
+    HANDDIST_TIMER(percentTimer, InstantiatePercentTime);
+    HANDDIST_COUNT(PercentRanges, 1);
     if ((m_isPercent = IsPercentRange(handText, m_lowerBound, m_upperBound))) {
-        int size = sizeof(HOLDEM_10_MAX_ORDERING)/sizeof(const char *);
-        int lowerBound = ((m_lowerBound * size)/100.0);
-        int upperBound = ((m_upperBound * size)/100.0);
+        const OrderingTable* table = m_ordering ? m_ordering : OrderingTables::DefaultHoldem();
+        if (table == NULL)
+            return 0;
+        int first, last;
+        table->Slice(m_lowerBound, m_upperBound, first, last);
         int count = 0;
-        for (int i=lowerBound; i < upperBound; i++) {
-            if (Parse(HoldemOrdering[i], deadCards)) {
-                count += Instantiate(HoldemOrdering[i], deadCards, specificHands);
+        for (int i=first; i < last; i++) {
+            if (Parse(table->Get(i), deadCards)) {
+                count += Instantiate(table->Get(i), deadCards, specificHands);
             }
         }
         return count;
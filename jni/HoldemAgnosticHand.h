@@ -20,9 +20,13 @@
 
 #pragma once
 
-// global table pointer
+// Legacy global table pointer. Prefer passing an OrderingTable to the hand
+// or distribution; this is only consulted when none is given.
 extern const char **HoldemOrdering;
 
+class OrderingTable;
+struct ParseError;
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // An "agnostic hand" is a Texas Hold'em starting hand devoid of specific
@@ -45,10 +49,15 @@ extern const char **HoldemOrdering;
 class HoldemAgnosticHand
 {
 public:
-	static int Parse(const char* handText, const char* deadCards);
-	static int Parse(const char* handText, StdDeck_CardMask deadCards);
+	HoldemAgnosticHand(const OrderingTable* ordering = NULL);
+
+	// Returns 1 if the text is a valid hand, class or range. Errors are
+	// reported through error, when given, and never printed.
+	static int Parse(const char* handText, const char* deadCards, ParseError* error = NULL);
+	static int Parse(const char* handText, StdDeck_CardMask deadCards, ParseError* error = NULL);
 
 	static char *GetEqvClasses(const char* handText);
+	static char *GetEqvClasses(const char* handText, const OrderingTable* ordering);
 
 	int Instantiate(const char* handText, const char* deadCards, vector<StdDeck_CardMask>& hands);
 	int Instantiate(const char* handText, StdDeck_CardMask deadCards, vector<StdDeck_CardMask>& hands);
@@ -58,6 +67,7 @@ public:
     static bool IsRandomHand(const char *handText);
 
 private:
+	const OrderingTable* m_ordering;
 	bool m_isPercent;
 	double m_lowerBound, m_upperBound;
 
@@ -0,0 +1,545 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <inlines/eval.h>
+#include "HandDistributions.h"
+#include "HoldemCalculator.h"
+#include "HoldemHandDistribution.h"
+#include "BoardEnumerator.h"
+#include "CardConverter.h"
+#include "EquityStatistics.h"
+#include "StratifiedSampler.h"
+#include "PreflopTable.h"
+#include "HandBitset.h"
+#include "HandCompatibility.h"
+#include "RandomEngine.h"
+#include "HandDistMetrics.h"
+#include <map>
+
+HoldemCalculator::HoldemCalculator(void)
+    : m_pDistributions(NULL), m_pOrdering(NULL), m_playerCount(0), m_trials(0), m_collisions(0),
+    m_targetError(0.0), m_timeLimit(0), m_pCancel(NULL),
+    m_engine(RandomEngine::Philox), m_seed(0), m_lastSeed(0), m_firstTrial(0), m_stratified(false)
+{
+    StdDeck_CardMask_RESET(m_dead);
+}
+
+HoldemCalculator::~HoldemCalculator(void)
+{
+    Clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Free the player distributions created by Init().
+///////////////////////////////////////////////////////////////////////////////
+void HoldemCalculator::Clear(void)
+{
+    HoldemHandDistribution* pDist = m_pDistributions;
+    while (pDist != NULL) {
+        HoldemHandDistribution* pNext = pDist->Next();
+        delete pDist;
+        pDist = pNext;
+    }
+
+    m_pDistributions = NULL;
+    m_playerCount = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Create one distribution per '|' separated player range, chained through
+// HoldemHandDistribution::m_pNext. Dead cards are removed from every
+// distribution when it is instantiated, board cards with SetDeadCards().
+//
+// A player's distribution from the previous call is kept when its range and
+// the dead cards are unchanged; only its alias table is rebuilt if the board
+// changed. Instantiating a random hand means building every hand in the deck,
+// which would otherwise dominate runs that simulate many hands or boards
+// against the same opponents.
+//
+// Returns the number of players, or 0 on a bad or empty range.
+///////////////////////////////////////////////////////////////////////////////
+int HoldemCalculator::Init(const char* hands, StdDeck_CardMask board, StdDeck_CardMask dead)
+{
+    StdDeck_CardMask excluded;
+    StdDeck_CardMask_OR(excluded, board, dead);
+
+    vector<HoldemHandDistribution*> previous;
+    if (StdDeck_CardMask_EQUAL(dead, m_dead)) {
+        for (HoldemHandDistribution* pDist = m_pDistributions; pDist != NULL; pDist = pDist->Next())
+            previous.push_back(pDist);
+    }
+    else {
+        Clear();
+    }
+    m_pDistributions = NULL;
+    m_playerCount = 0;
+    m_dead = dead;
+
+    string text(hands ? hands : "");
+    HoldemHandDistribution* pLast = NULL;
+    bool valid = true;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find('|', start);
+        if (end == string::npos)
+            end = text.size();
+
+        string range = text.substr(start, end - start);
+        HoldemHandDistribution* pDist = NULL;
+        if ((size_t)m_playerCount < previous.size()) {
+            pDist = previous[m_playerCount];
+            previous[m_playerCount] = NULL;
+            if (range != pDist->GetText() || pDist->GetOrdering() != m_pOrdering) {
+                delete pDist;
+                pDist = NULL;
+            }
+        }
+
+        if (pDist == NULL) {
+            pDist = new HoldemHandDistribution();
+            pDist->SetOrdering(m_pOrdering);
+            if (range.empty() || pDist->Init(range.c_str(), dead) <= 0)
+                valid = false;
+        }
+
+        if (valid && pDist->SetDeadCards(excluded) <= 0)
+            valid = false;
+
+        pDist->m_pNext = NULL;
+        if (pLast == NULL)
+            m_pDistributions = pDist;
+        else
+            pLast->m_pNext = pDist;
+        pLast = pDist;
+        m_playerCount++;
+
+        start = end + 1;
+    }
+
+    for (size_t i = 0; i < previous.size(); i++)
+        delete previous[i];
+
+    if (!valid) {
+        Clear();
+        return 0;
+    }
+
+    return m_playerCount;
+}
+
+int HoldemCalculator::Calculate(const char* hands, const char* board, const char* dead, int64_t numberOfTrials, double* results)
+{
+    return Calculate(hands, CardConverter::TextToPokerEval(board), CardConverter::TextToPokerEval(dead), numberOfTrials, results);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Run the simulation. The players' hands are dealt in turn from the hands of
+// their distribution that are compatible with the hands dealt before them.
+// Two plain draws are tried first; if both collide the possible hands are
+// the AND of the distribution's live hands and one HandCompatibility row per
+// earlier player, and one is picked from those. A trial in which some player
+// has no possible hand left is thrown out and counted as a collision.
+//
+// The run ends after numberOfTrials trials, or earlier when the target error
+// or time limit is reached or the run is cancelled; this is checked every
+// CHECK_INTERVAL trials so the clock isn't read on every one.
+///////////////////////////////////////////////////////////////////////////////
+int HoldemCalculator::Calculate(const char* hands, StdDeck_CardMask board, StdDeck_CardMask dead, int64_t numberOfTrials, double* results)
+{
+    m_trials = 0;
+    m_collisions = 0;
+    m_errors.clear();
+
+    if (Init(hands, board, dead) == 0)
+        return 0;
+    m_errors.assign(m_playerCount, 0.0);
+
+    StdDeck_CardMask used;
+    StdDeck_CardMask_OR(used, board, dead);
+
+    if (StdDeck_CardMask_IS_EMPTY(used) && LookupPreflop(results))
+        return m_playerCount;
+
+    int boardCards = 0;
+    for (int card = 0; card < StdDeck_N_CARDS; card++) {
+        if (StdDeck_CardMask_CARD_IS_SET(board, card))
+            boardCards++;
+    }
+
+    // Each player's live hands as a bitset over all 1,326 hands, the hand
+    // number of each of the distribution's hands and, for weighted ranges,
+    // the weight of each hand number
+    const HandCompatibility& compatibility = HandCompatibility::Holdem();
+    int words = compatibility.GetWords();
+    vector< vector<uint64_t> > live(m_playerCount, vector<uint64_t>(words, 0));
+    vector< vector<int> > handIndex(m_playerCount);
+    vector< vector<double> > weights(m_playerCount);
+    vector<StdDeck_CardMask> handByIndex(compatibility.GetColumns());
+
+    int player = 0;
+    for (HoldemHandDistribution* pDist = m_pDistributions; pDist != NULL; pDist = pDist->Next(), player++) {
+        handIndex[player].resize(pDist->GetCount());
+        if (pDist->IsWeighted())
+            weights[player].resize(compatibility.GetColumns(), 0.0);
+
+        for (int i = 0; i < pDist->GetCount(); i++) {
+            int index = HandBitset::Index(pDist->Get(i), 2);
+            handIndex[player][i] = index;
+            handByIndex[index] = pDist->Get(i);
+            if (!StdDeck_CardMask_ANY_SET(pDist->Get(i), used))
+                live[player][index >> 6] |= (uint64_t)1 << (index & 63);
+            if (pDist->IsWeighted())
+                weights[player][index] = pDist->GetWeight(i);
+        }
+    }
+
+    vector<double> shares(m_playerCount);
+    EquityStatistics stats(m_playerCount, m_targetError, m_timeLimit);
+    vector<StdDeck_CardMask> holeCards(m_playerCount);
+    vector<HandVal> handValues(m_playerCount);
+    vector<int> chosen(m_playerCount);
+    vector<uint64_t> possible(words);
+    m_lastSeed = m_seed ? m_seed : RandomEngine::NewSeed();
+    RandomEngine* pEngine = RandomEngine::Create(m_engine, m_lastSeed);
+    if (pEngine == NULL)
+        return 0;
+    RandomEngine& rand = *pEngine;
+
+    // Stratified mode draws its orders and shifts from a stream of its own
+    StratifiedSampler sampler;
+    if (m_stratified) {
+        for (HoldemHandDistribution* pDist = m_pDistributions; pDist != NULL; pDist = pDist->Next()) {
+            vector<int> hands;
+            vector<double> handWeights;
+            for (int i = 0; i < pDist->GetCount(); i++) {
+                if (StdDeck_CardMask_ANY_SET(pDist->Get(i), used) || pDist->GetWeight(i) <= 0.0)
+                    continue;
+                hands.push_back(i);
+                if (pDist->IsWeighted())
+                    handWeights.push_back(pDist->GetWeight(i));
+            }
+            sampler.AddPlayer(hands, handWeights);
+        }
+        rand.Seek(~(uint64_t)0);
+        sampler.Init(rand);
+    }
+
+    for (int64_t trial = 0; trial < numberOfTrials; trial++) {
+        if (trial % EquityStatistics::CHECK_INTERVAL == 0 && trial > 0 && (stats.IsDone() || (m_pCancel != NULL && *m_pCancel)))
+            break;
+
+        rand.Seek(m_firstTrial + trial);
+        StdDeck_CardMask trialDead = used;
+        bool bCollision = false;
+
+        player = 0;
+        for (HoldemHandDistribution* pDist = m_pDistributions; pDist != NULL; pDist = pDist->Next(), player++) {
+            // The stratified pick, then a couple of plain draws: wide
+            // ranges rarely collide
+            chosen[player] = -1;
+            if (m_stratified) {
+                int i = sampler.Hand(player, m_firstTrial + trial);
+                if (i >= 0 && !StdDeck_CardMask_ANY_SET(pDist->Get(i), trialDead))
+                    chosen[player] = handIndex[player][i];
+            }
+            for (int attempt = 0; attempt < 2 && chosen[player] < 0; attempt++) {
+                int i = pDist->Sample(rand);
+                if (!StdDeck_CardMask_ANY_SET(pDist->Get(i), trialDead))
+                    chosen[player] = handIndex[player][i];
+            }
+
+            if (chosen[player] < 0) {
+                possible = live[player];
+                for (int prior = 0; prior < player; prior++) {
+                    const uint64_t* row = compatibility.Row(chosen[prior]);
+                    for (int w = 0; w < words; w++)
+                        possible[w] &= row[w];
+                }
+
+                chosen[player] = HandCompatibility::Choose(&possible[0], words, weights[player],
+                    pDist->m_alias, &handIndex[player][0], rand);
+                if (chosen[player] < 0) {
+                    bCollision = true;
+                    break;
+                }
+            }
+
+            holeCards[player] = handByIndex[chosen[player]];
+            StdDeck_CardMask_OR(trialDead, trialDead, holeCards[player]);
+        }
+
+        if (bCollision) {
+            m_collisions++;
+            continue;
+        }
+
+        // Deal out the rest of the board
+        StdDeck_CardMask trialBoard = board;
+        if (m_stratified)
+            sampler.DealBoard(m_firstTrial + trial, 5 - boardCards, trialDead, trialBoard);
+        for (int dealt = m_stratified ? 5 : boardCards; dealt < 5; ) {
+            int card = rand.Below(StdDeck_N_CARDS);
+            if (StdDeck_CardMask_CARD_IS_SET(trialDead, card))
+                continue;
+            StdDeck_CardMask_SET(trialDead, card);
+            StdDeck_CardMask_SET(trialBoard, card);
+            dealt++;
+        }
+
+        HandVal best = 0;
+        int winners = 0;
+        for (player = 0; player < m_playerCount; player++) {
+            StdDeck_CardMask cards;
+            StdDeck_CardMask_OR(cards, holeCards[player], trialBoard);
+            handValues[player] = StdDeck_StdRules_EVAL_N(cards, 7);
+            if (winners == 0 || handValues[player] > best) {
+                best = handValues[player];
+                winners = 1;
+            }
+            else if (handValues[player] == best) {
+                winners++;
+            }
+        }
+
+        for (player = 0; player < m_playerCount; player++)
+            shares[player] = (handValues[player] == best) ? 1.0 / winners : 0.0;
+
+        stats.Add(&shares[0]);
+        m_trials++;
+    }
+
+    HANDDIST_COUNT(Trials, m_trials);
+    HANDDIST_COUNT(TrialCollisions, m_collisions);
+
+    for (int player = 0; player < m_playerCount; player++) {
+        results[player] = stats.GetMean(player);
+        m_errors[player] = stats.GetStandardError(player);
+    }
+
+    delete pEngine;
+    return m_playerCount;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Run out every remaining board for one pair of hands. Boards that are the
+// same up to a suit permutation fixing both hands and the dead cards give
+// the same result, so only one board per class is evaluated, counted as
+// many times as its class has boards.
+///////////////////////////////////////////////////////////////////////////////
+static void EnumerateBoards(StdDeck_CardMask hand0, StdDeck_CardMask hand1, StdDeck_CardMask board, StdDeck_CardMask dead,
+    int cardsLeft, double& share0, double& share1, int64_t& boardCount)
+{
+    StdDeck_CardMask fixed[3] = { hand0, hand1, dead };
+    BoardEnumerator enumerator(fixed, 3);
+
+    vector<StdDeck_CardMask> boards;
+    vector<int> weights;
+    enumerator.Enumerate(board, cardsLeft, boards, weights);
+
+    for (size_t b = 0; b < boards.size(); b++) {
+        StdDeck_CardMask cards0, cards1;
+        StdDeck_CardMask_OR(cards0, hand0, boards[b]);
+        StdDeck_CardMask_OR(cards1, hand1, boards[b]);
+
+        HandVal val0 = StdDeck_StdRules_EVAL_N(cards0, 7);
+        HandVal val1 = StdDeck_StdRules_EVAL_N(cards1, 7);
+        if (val0 > val1) {
+            share0 += weights[b];
+        }
+        else if (val1 > val0) {
+            share1 += weights[b];
+        }
+        else {
+            share0 += 0.5 * weights[b];
+            share1 += 0.5 * weights[b];
+        }
+        boardCount += weights[b];
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Whether a range is made of whole starting hand classes (6 combinations of a
+// pair, 4 of a suited hand, 12 of an offsuit one) with one weight per class.
+// Class against class equities are averages over the pairs of combinations
+// that don't share a card, so they add up to the exact equity of such ranges
+// and of no others.
+///////////////////////////////////////////////////////////////////////////////
+static bool IsWholeClasses(const HoldemHandDistribution* pDist)
+{
+    int counts[PreflopTable::ClassCount] = { 0 };
+    double weights[PreflopTable::ClassCount];
+    for (int i = 0; i < pDist->GetCount(); i++) {
+        int handClass = PreflopTable::ClassOf(pDist->Get(i));
+        if (handClass < 0 || (counts[handClass] > 0 && weights[handClass] != pDist->GetWeight(i)))
+            return false;
+        weights[handClass] = pDist->GetWeight(i);
+        counts[handClass]++;
+    }
+
+    for (int handClass = 0; handClass < PreflopTable::ClassCount; handClass++) {
+        int hi = handClass / 13, lo = handClass % 13;
+        int combos = hi == lo ? 6 : (hi > lo ? 4 : 12);
+        if (counts[handClass] != 0 && counts[handClass] != combos)
+            return false;
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Heads-up preflop fast path: combine the precomputed equities of every pair
+// of hands that don't share a card, weighted like Enumerate() does. This is
+// exact with the hand against hand table; with only the class table it is
+// used for ranges of whole classes alone (see IsWholeClasses). Returns 0 (and
+// the caller computes the equity itself) when there is no usable table.
+///////////////////////////////////////////////////////////////////////////////
+int HoldemCalculator::LookupPreflop(double* results)
+{
+    const PreflopTable* table = PreflopTable::Get();
+    if (table == NULL || m_playerCount != 2)
+        return 0;
+
+    HoldemHandDistribution* pDist0 = m_pDistributions;
+    HoldemHandDistribution* pDist1 = pDist0->Next();
+    if (!table->HasCombos() && (!IsWholeClasses(pDist0) || !IsWholeClasses(pDist1)))
+        return 0;
+
+    double equity = 0.0, totalWeight = 0.0;
+    int64_t pairs = 0;
+    for (int i = 0; i < pDist0->GetCount(); i++) {
+        StdDeck_CardMask hand0 = pDist0->Get(i);
+        for (int j = 0; j < pDist1->GetCount(); j++) {
+            StdDeck_CardMask hand1 = pDist1->Get(j);
+            if (StdDeck_CardMask_ANY_SET(hand0, hand1))
+                continue;
+
+            double weight = pDist0->GetWeight(i) * pDist1->GetWeight(j);
+            equity += weight * table->Equity(hand0, hand1);
+            totalWeight += weight;
+            pairs++;
+        }
+    }
+
+    if (totalWeight <= 0.0)
+        return 0;
+
+    results[0] = equity / totalWeight;
+    results[1] = 1.0 - results[0];
+    m_trials = pairs;
+    return 2;
+}
+
+int HoldemCalculator::Enumerate(const char* hands, const char* board, const char* dead, double* results)
+{
+    return Enumerate(hands, CardConverter::TextToPokerEval(board), CardConverter::TextToPokerEval(dead), results);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Exact enumeration. Two hand pairs that are the same up to a permutation of
+// the suits which leaves the board and dead cards in place (all 24 of them
+// preflop) have the same equity, so the boards are only run out for one pair
+// of each class: AA vs KK preflop is 36 pairs but just 3 classes. Weighted
+// ranges weigh each pair by the product of the two hand weights.
+///////////////////////////////////////////////////////////////////////////////
+int HoldemCalculator::Enumerate(const char* hands, StdDeck_CardMask board, StdDeck_CardMask dead, double* results)
+{
+    m_trials = 0;
+    m_collisions = 0;
+    m_errors.clear();
+
+    if (Init(hands, board, dead) != 2)
+        return 0;
+    m_errors.assign(m_playerCount, 0.0);
+
+    StdDeck_CardMask excluded;
+    StdDeck_CardMask_OR(excluded, board, dead);
+
+    if (StdDeck_CardMask_IS_EMPTY(excluded) && LookupPreflop(results))
+        return 2;
+
+    int boardCards = 0;
+    for (int card = 0; card < StdDeck_N_CARDS; card++) {
+        if (StdDeck_CardMask_CARD_IS_SET(board, card))
+            boardCards++;
+    }
+    if (boardCards > 5)
+        return 0;
+
+    // The suit permutations that map the board and the dead cards onto
+    // themselves
+    vector< vector<int> > perms;
+    int perm[4] = { 0, 1, 2, 3 };
+    do {
+        StdDeck_CardMask permutedBoard = BoardEnumerator::PermuteSuits(board, perm);
+        StdDeck_CardMask permutedDead = BoardEnumerator::PermuteSuits(dead, perm);
+        if (StdDeck_CardMask_EQUAL(permutedBoard, board) && StdDeck_CardMask_EQUAL(permutedDead, dead))
+            perms.push_back(vector<int>(perm, perm + 4));
+    } while (std::next_permutation(perm, perm + 4));
+
+    HoldemHandDistribution* pDist0 = m_pDistributions;
+    HoldemHandDistribution* pDist1 = pDist0->Next();
+
+    map< pair<uint64_t, uint64_t>, pair<double, double> > classes;
+    double equity0 = 0.0, equity1 = 0.0, totalWeight = 0.0;
+
+    for (int i = 0; i < pDist0->GetCount(); i++) {
+        StdDeck_CardMask hand0 = pDist0->Get(i);
+        if (StdDeck_CardMask_ANY_SET(hand0, excluded))
+            continue;
+
+        for (int j = 0; j < pDist1->GetCount(); j++) {
+            StdDeck_CardMask hand1 = pDist1->Get(j);
+            if (StdDeck_CardMask_ANY_SET(hand1, excluded) || StdDeck_CardMask_ANY_SET(hand0, hand1))
+                continue;
+
+            pair<uint64_t, uint64_t> key(hand0.cards_n, hand1.cards_n);
+            for (size_t p = 1; p < perms.size(); p++) {
+                pair<uint64_t, uint64_t> permuted(BoardEnumerator::PermuteSuits(hand0, &perms[p][0]).cards_n,
+                    BoardEnumerator::PermuteSuits(hand1, &perms[p][0]).cards_n);
+                if (permuted < key)
+                    key = permuted;
+            }
+
+            map< pair<uint64_t, uint64_t>, pair<double, double> >::iterator it = classes.find(key);
+            if (it == classes.end()) {
+                double share0 = 0.0, share1 = 0.0;
+                int64_t boards = 0;
+                EnumerateBoards(hand0, hand1, board, dead, 5 - boardCards, share0, share1, boards);
+                m_trials += boards;
+
+                it = classes.insert(make_pair(key, make_pair(share0 / boards, share1 / boards))).first;
+            }
+
+            double weight = pDist0->GetWeight(i) * pDist1->GetWeight(j);
+            equity0 += weight * it->second.first;
+            equity1 += weight * it->second.second;
+            totalWeight += weight;
+        }
+    }
+
+    if (totalWeight <= 0.0)
+        return 0;
+
+    results[0] = equity0 / totalWeight;
+    results[1] = equity1 / totalWeight;
+    return 2;
+}
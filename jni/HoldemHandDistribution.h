@@ -20,6 +20,13 @@
 
 #pragma once
 
+#include "AliasTable.h"
+#include "ParseError.h"
+
+class OrderingTable;
+class HandBitset;
+class RandomEngine;
+
 ///////////////////////////////////////////////////////////////////////////////
 // A distribution containing one or more specific Hold'em hands. We create
 // one of these for each player involved in the matchup, EVEN IF THE PLAYER
@@ -32,30 +39,64 @@ public:
 	HoldemHandDistribution();
 	HoldemHandDistribution(const char* hand);
 	HoldemHandDistribution(const char* hand, StdDeck_CardMask deadCards);
+	HoldemHandDistribution(const char* hand, StdDeck_CardMask deadCards, const OrderingTable* ordering);
 	virtual ~HoldemHandDistribution(void);
 
 	int Init(const char* hand);
 	int Init(const char* hand, StdDeck_CardMask dead);
+	int SetDeadCards(StdDeck_CardMask deadCards);
 	StdDeck_CardMask Choose(StdDeck_CardMask deadCards, bool& bCollisionError);
+	StdDeck_CardMask Choose(StdDeck_CardMask deadCards, bool& bCollisionError, RandomEngine& rand);
+	int Sample(RandomEngine& rand) const;
 	StdDeck_CardMask Get(int index) const { return m_hands[index]; }
 	StdDeck_CardMask Current() const { return m_current; }
 	void SetCurrent( StdDeck_CardMask cur) { m_current = cur; }
 	const char* GetText() const { return m_handText.c_str(); }
 
+	// Why the last Init() left out part of its range, if it did; the offset
+	// is into the text given to Init().
+	const ParseError& GetError() const { return m_error; }
+
+	// Check the syntax of a range without instantiating any hands, e.g. to
+	// vet ranges in bulk. Returns false at the first error, which goes into
+	// error if it isn't NULL.
+	static bool Validate(const char* hand, ParseError* error = NULL);
+
+	// Ordering table used to resolve percent ranges; NULL selects the default.
+	void SetOrdering(const OrderingTable* ordering) { m_pOrdering = ordering; }
+	const OrderingTable* GetOrdering() const { return m_pOrdering; }
+
 
 	static bool IsSpecificHand(const char* handText);
 	int GetCount() const { return m_hands.size(); }
+	int GetLiveCount() const { return m_liveCount; }
+	bool IsWeighted() const { return !m_weights.empty(); }
+	double GetWeight(int index) const { return m_weights.empty() ? 1.0 : m_weights[index]; }
 	bool IsUnary() const { return m_hands.size() == 1; }
 
 	friend class HoldemCalculator; // terrible programmer...
+	friend class DistributionCodec;
+	friend class RangeCache;
 
 private:
 	static bool CardMaskGreaterThan( StdDeck_CardMask a, StdDeck_CardMask b );
 	static bool CardMaskEqual( StdDeck_CardMask a, StdDeck_CardMask b );
+	static double SplitWeight(char* pElem);
+	static bool ExpandOperand(const char* operand, HandBitset& hands, void* context);
+	static bool CheckOperand(const char* operand, void* context);
+	static bool CheckTerm(const char* term, int start, ParseError& error);
+	void RemoveDuplicates();
 	HoldemHandDistribution* Next() const { return m_pNext; }
 
 	string m_handText;
+	ParseError m_error;
 	HoldemHandDistribution* m_pNext;
+	const OrderingTable* m_pOrdering;
 	vector<StdDeck_CardMask> m_hands;
+	vector<double> m_weights;	// parallel to m_hands, empty if all are 1
+	AliasTable m_alias;			// empty when sampling uniformly
+	StdDeck_CardMask m_aliasDead;
+	bool m_aliasValid;
+	int m_liveCount;
 	StdDeck_CardMask m_current;
 };
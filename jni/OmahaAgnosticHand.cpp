@@ -23,10 +23,9 @@
 #include "OmahaAgnosticHand.h"
 #include "CardConverter.h"
 #include "Card.h"
-#include "oh10maxordering.h"
-#include "oh6maxordering.h"
-#include "o810maxordering.h"
-#include "o86maxordering.h"
+#include "OrderingTables.h"
+#include "HandDistMetrics.h"
+#include "ParseError.h"
 
 #ifdef MY_DEBUG
 #define dbg_printf(...) printf(__VA_ARGS__);
@@ -38,6 +37,13 @@
 
 const char **OmahaOrdering = NULL;
 
+// What Parse() expects where it fails, for ParseError::expected
+static const char* const EXPECT_RANK = "a rank (AKQJT98765432)";
+static const char* const EXPECT_CARD = "a rank, a rank group (BRFMZLNYX), '[', ']' or ':'";
+static const char* const EXPECT_GAP = "a gap from 0 to 12";
+static const char* const EXPECT_FILTER = "a filter such as /ds or /np";
+static const char* const EXPECT_END = "a filter or the end of the hand";
+
 ///////////////////////////////////////////////////////////////////////////////
 // Take a given agnostic hand, such as "AKQJ" or "T+T+T+T+" or "A-TA-TTT-77", along with
 // an optional collection of "dead" cards, and boil it down into its constituent
@@ -166,7 +172,12 @@ static bool funcIsSuitedNonAce(int rank0, int rank1, int rank2, int rank3,
     return false;
 }
 
-OmahaAgnosticHand::OmahaAgnosticHand(void)
+///////////////////////////////////////////////////////////////////////////////
+// Percent ranges ("15%", "10-25%") are resolved against the given ordering
+// table, or against OrderingTables::DefaultOmaha() if none is given.
+///////////////////////////////////////////////////////////////////////////////
+OmahaAgnosticHand::OmahaAgnosticHand(const OrderingTable* ordering)
+    : m_ordering(ordering)
 {
     Reset();
 }
@@ -206,30 +217,27 @@ void OmahaAgnosticHand::Reset(void)
     }
 }
 
-int OmahaAgnosticHand::Parse(const char* handText, const char* deadText)
+int OmahaAgnosticHand::Parse(const char* handText, const char* deadText, ParseError* error)
 {
+    // Malformed dead cards fail the parse
     StdDeck_CardMask deadCards;
-    StdDeck_CardMask_RESET(deadCards);
-
-    int len = deadText ? strlen(deadText) : 0;
-    if (len > 0) {
-        int suit, rank;
-        StdDeck_CardMask hand;
-        const char* pCard = deadText;
-        for(int i=0; i < len && *pCard != '\0'; i+=2) {
-            rank = Card::CharToRank(*pCard);
-            suit = Card::CharToSuit(*(pCard+1));
-            hand = StdDeck_MASK( StdDeck_MAKE_CARD(rank, suit) );
-            StdDeck_CardMask_OR(deadCards, deadCards, hand);
-            pCard += 2;
-        }
+    if (CardConverter::TextToPokerEval(deadText, deadCards) < 0) {
+        if (error != NULL)
+            error->Set(ParseError::BadDeadCards, 0, "cards such as AhKdQcJs");
+        return 0;
     }
 
-    return Parse(handText, deadCards);
+    return Parse(handText, deadCards, error);
 }
 
-int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
+///////////////////////////////////////////////////////////////////////////////
+// Check the syntax of an agnostic hand and keep what it describes for
+// Instantiate(). On an error, error (if not NULL) gets what went wrong and
+// where; nothing is printed.
+///////////////////////////////////////////////////////////////////////////////
+int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards, ParseError* error)
 {
+    HANDDIST_TIMER(parseTimer, ParseTime);
     Reset(); // start fresh every time
 
     if (strcmp(handText, "XXXX") == 0) {
@@ -255,6 +263,8 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
 
     bool firstSuit = true;
     bool isSuited = false;
+    ParseError::Code code = ParseError::UnexpectedChar;
+    const char* expected = "";
 
     //   // rank filters
     //   bool isNoPair = false, isNoTrips = false, isNoQuads = false,
@@ -269,6 +279,8 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
     int cur = 0;
     while (*p != '\0' && *p != '/') {
         while (*p == ' ') p++;
+        if (*p == '\0')
+            break; // trailing blanks
     
         if (m_seenCards == OMAHA_MAXHOLE) {
             // we can only close any suited sections after
@@ -277,18 +289,20 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                     isSuited = false;
                 }
                 else {
-                    printf("Closing ']' in non-bracketed section\n");
+                    code = ParseError::UnopenedBracket;
                     goto error;
                 }
                 p++; while (*p == ' ') p++;
             }
             else {
                 if (isSuited) {
-                    printf("No closing ']' found, %s\n", p);
+                    code = ParseError::UnclosedBracket;
+                    expected = "]";
                     goto error;
                 }
                 else {
-                    printf("Unrecognized chars %s\n", p);
+                    code = ParseError::ExtraChars;
+                    expected = EXPECT_END;
                     goto error;
                 }
             }
@@ -314,7 +328,7 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                 dbg_printf("m_suitType[%d]=Any, %s\n", cur, p);
             }
             else {
-                printf("Closing ']' in non-bracketed section\n");
+                code = ParseError::UnopenedBracket;
                 goto error;
             }
             p++; while (*p == ' ') p++;
@@ -324,7 +338,8 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
             if (NULL != strchr("0123456789", *p)) {
                 m_gap[cur] = atoi(p);
                 if (m_gap[cur] > 12 || m_gap[cur] < 0) {
-                    printf("gap error: 0 < \"%d\" < 12\n", m_gap[cur]);
+                    code = ParseError::BadGap;
+                    expected = EXPECT_GAP;
                     goto error;
                 }
                 
@@ -345,7 +360,8 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                 m_seenCards++;
             }
             else {
-                printf("non-digit gap: %c\n", *p);
+                code = ParseError::BadGap;
+                expected = EXPECT_GAP;
                 goto error;
             }
         }
@@ -361,7 +377,7 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                         p++; while (*p == ' ') p++;
                     }
                     else {
-                        printf("%c not in \"AaKkQqJjTt98765432\"\n", *p);
+                        expected = EXPECT_RANK;
                         goto error;
                     }
                     if (m_rankCeil[cur] < m_rankFloor[cur]) {
@@ -434,7 +450,7 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                         m_rankCeil[cur] = Card::Ace;
                         break;
                     default:
-                        printf("%c not in \"BbRrFfMmZzLlNnYyXx\"\n", *p);
+                        expected = EXPECT_CARD;
                         goto error;
                 }
         
@@ -443,7 +459,7 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
       
             if (*p != '\0' && NULL != strchr("CcDdHhSs", *p)) {
                 if (isSuited) {
-                    printf("Suit %c specified in [] section\n", *p);
+                    code = ParseError::SuitInBrackets;
                     goto error;
                 }
 	
@@ -476,18 +492,20 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
             cur++;
         }
         else {
-            printf("Unrecognized char %c\n", *p);
+            expected = EXPECT_CARD;
             goto error;
         }
     }
 
     if (isSuited) {
-        printf("No closing ']' found, %s\n", p);
+        code = ParseError::UnclosedBracket;
+        expected = "]";
         goto error;
     }
 
     if (m_seenCards != OMAHA_MAXHOLE) {
-        printf("Need to specify 4 cards per hand, specified: %d\n", m_seenCards);
+        code = ParseError::MissingCards;
+        expected = EXPECT_CARD;
         goto error;
     }
   
@@ -508,7 +526,8 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                     m_isNoQuads = true;
                 }
                 else {
-                    printf("Unrecognized filter /n%c\n", *p);
+                    code = ParseError::BadFilter;
+                    expected = "/np, /nt or /nq";
                     goto error;
                 }
                 p++;
@@ -522,6 +541,12 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                 else if (*p != '\0' && NULL != strchr("Ss", *p)) {
                     m_isOneSuited = true;
                 }
+                else {
+                    code = ParseError::BadFilter;
+                    expected = "/op or /os";
+                    goto error;
+                }
+                p++;
             }
             else if (*p != '\0' && NULL != strchr("Tt", *p)) {
                 p++;
@@ -535,7 +560,8 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                     m_isThreeOfSuit = true;
                 }
                 else {
-                    printf("Unrecognized filter /t%c\n", *p);
+                    code = ParseError::BadFilter;
+                    expected = "/tp, /tr or /ts";
                     goto error;
                 }
                 p++;
@@ -546,7 +572,8 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                     m_isQuads = true;
                 }
                 else {
-                    printf("Unrecognized filter /q%c\n", *p);	  
+                    code = ParseError::BadFilter;
+                    expected = "/qu";
                     goto error;
                 }
                 p++;
@@ -557,18 +584,8 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                     m_isRainbow = true;
                 }
                 else {
-                    printf("Unrecognized filter /r%c\n", *p);
-                    goto error;
-                }
-                p++;
-            }
-            else if (*p != '\0' && NULL != strchr("Oo", *p)) {
-                p++;
-                if (*p != '\0' && NULL != strchr("Ss", *p)) {
-                    m_isOneSuited = true;
-                }
-                else {
-                    printf("Unrecognized filter /o%c\n", *p);
+                    code = ParseError::BadFilter;
+                    expected = "/rb";
                     goto error;
                 }
                 p++;
@@ -579,7 +596,8 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                     m_isDoubleSuited = true;
                 }
                 else {
-                    printf("Unrecognized filter /d%c\n", *p);
+                    code = ParseError::BadFilter;
+                    expected = "/ds";
                     goto error;
                 }
                 p++;
@@ -590,7 +608,8 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                     m_isMonotone = true;
                 }
                 else {
-                    printf("Unrecognized filter /m%c\n", *p);
+                    code = ParseError::BadFilter;
+                    expected = "/mt";
                     goto error;
                 }
                 p++;
@@ -609,12 +628,14 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                         m_isSuitedNonAce = true;
                     }
                     else {
-                        printf("Unrecognized filter /sn%c\n", *p);
+                        code = ParseError::BadFilter;
+                        expected = "/sna";
                         goto error;
                     }
                 }
                 else {
-                    printf("Unrecognized filter /s%c\n", *p);
+                    code = ParseError::BadFilter;
+                    expected = "/ss, /sa or /sna";
                     goto error;
                 }
                 p++;
@@ -632,12 +653,14 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                             m_isAtLeastTrips = true;
                         }
                         else {
-                            printf("Unrecognized filter /alt%c\n", *p);
+                            code = ParseError::BadFilter;
+                            expected = "/alts or /altr";
                             goto error;
                         }
                     }
                     else {
-                        printf("Unrecognized filter /al%c\n", *p);
+                        code = ParseError::BadFilter;
+                        expected = "/alts or /altr";
                         goto error;
                     }
                 }
@@ -647,7 +670,8 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                         m_isAtLeastSingleSuit = true;
                     }
                     else {
-                        printf("Unrecognized filter /as%c\n", *p);
+                        code = ParseError::BadFilter;
+                        expected = "/ass";
                         goto error;
                     }
                 }
@@ -657,23 +681,31 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
                         m_isAtLeastOnePair = true;
                     }
                     else {
-                        printf("Unrecognized filter /ao%c\n", *p);
+                        code = ParseError::BadFilter;
+                        expected = "/aop";
                         goto error;
                     }
                 }
                 else {
-                    printf("Unrecognized filter /a%c\n", *p);
+                    code = ParseError::BadFilter;
+                    expected = "/alts, /altr, /ass or /aop";
                     goto error;
                 }
                 p++;
             }
+            else {
+                code = ParseError::BadFilter;
+                expected = EXPECT_FILTER;
+                goto error;
+            }
       
             while (*p == ' ') p++;
         }	
     }
-    else if (*p != '\0') {
+    if (*p != '\0') {
         // we should have ended input
-        printf("Extra characters at end of input: %s\n", p);
+        code = ParseError::ExtraChars;
+        expected = EXPECT_END;
         goto error;
     }
     dbg_printf("1:%d-%d/%d-%d, 2:%d-%d/%d-%d, 3:%d-%d/%d-%d, 4:%d-%d/%d-%d\n",
@@ -685,25 +717,17 @@ int OmahaAgnosticHand::Parse(const char* handText, StdDeck_CardMask deadCards)
     return 1; // success
 
   error:
-    printf("Error parsing %s, parsing at %s: %d\n", handText, p, p-handText+1);
+    if (error != NULL)
+        error->Set(*p == '\0' && code == ParseError::UnexpectedChar ? ParseError::MissingCards : code, (int)(p - handText), expected);
     return 0; // failure
 }
 
 int OmahaAgnosticHand::Instantiate(const char* handText, const char* deadText, vector<StdDeck_CardMask>& specificHands)
 {
+    // Malformed dead cards match no hands
     StdDeck_CardMask deadCards;
-    StdDeck_CardMask_RESET(deadCards);
-                
-    if (deadText && strlen(deadText)) {
-        int suit, rank;
-        StdDeck_CardMask hand;
-        for(const char* pCard = deadText; pCard != NULL; pCard += 2) {
-            rank = Card::CharToRank(*pCard);
-            suit = Card::CharToSuit(*(pCard+1));
-            hand = StdDeck_MASK( StdDeck_MAKE_CARD(rank, suit) );
-            StdDeck_CardMask_OR(deadCards, deadCards, hand);
-        }
-    }
+    if (CardConverter::TextToPokerEval(deadText, deadCards) < 0)
+        return 0;
 
     return Instantiate(handText, deadCards, specificHands);
 }
@@ -723,6 +747,7 @@ int OmahaAgnosticHand::Instantiate(const char* handText, StdDeck_CardMask deadCa
     }
 
     if (IsSpecificHand(handText)) {
+        HANDDIST_TIMER(specificTimer, InstantiateSpecificTime);
         specificHands.push_back(CardConverter::TextToPokerEval(handText));
         return specificHands.size();
     }
@@ -737,6 +762,8 @@ int OmahaAgnosticHand::Instantiate(const char* handText, StdDeck_CardMask deadCa
     if (m_seenCards != 4 && !m_isPercent)
         return 0;
 
+    HANDDIST_TIMER(classTimer, InstantiateClassTime);
+
     StdDeck_CardMask card1, card2, card3, card4;
     StdDeck_CardMask hand;
     int combos = 0;
@@ -941,6 +968,7 @@ int OmahaAgnosticHand::Instantiate(const char* handText, StdDeck_CardMask deadCa
 ///////////////////////////////////////////////////////////////////////////////
 int OmahaAgnosticHand::InstantiateRandom(StdDeck_CardMask deadCards, vector<StdDeck_CardMask>& specificHands)
 {
+    HANDDIST_TIMER(randomTimer, InstantiateRandomTime);
     StdDeck_CardMask curHand;
     DECK_ENUMERATE_4_CARDS_D(StdDeck, curHand, deadCards, specificHands.push_back(curHand); );
     return specificHands.size();
@@ -1036,14 +1064,18 @@ bool OmahaAgnosticHand::IsPercentRange(const char* handText, double &lowerBound,
 
 int OmahaAgnosticHand::InstantiatePercentRange(const char* handText, StdDeck_CardMask deadCards, vector<StdDeck_CardMask>& specificHands)
 {
+    HANDDIST_TIMER(percentTimer, InstantiatePercentTime);
+    HANDDIST_COUNT(PercentRanges, 1);
     if ((m_isPercent = IsPercentRange(handText, m_lowerBound, m_upperBound))) {
-        int size = sizeof(OMAHA_10_MAX_ORDERING)/sizeof(const char *);
-        int lowerBound = ((m_lowerBound * size)/100.0);
-        int upperBound = ((m_upperBound * size)/100.0);
+        const OrderingTable* table = m_ordering ? m_ordering : OrderingTables::DefaultOmaha();
+        if (table == NULL)
+            return 0; // external orderings were not loaded
+        int first, last;
+        table->Slice(m_lowerBound, m_upperBound, first, last);
         int count = 0;
-        for (int i=lowerBound; i < upperBound; i++) {
-            if (Parse(OmahaOrdering[i], deadCards)) {
-                count += this->Instantiate(OmahaOrdering[i], deadCards, specificHands);
+        for (int i=first; i < last; i++) {
+            if (Parse(table->Get(i), deadCards)) {
+                count += this->Instantiate(table->Get(i), deadCards, specificHands);
             }
         }
         return count;
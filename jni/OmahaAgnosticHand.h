@@ -20,9 +20,13 @@
 
 #pragma once
 
-// global table pointer
+// Legacy global table pointer. Prefer passing an OrderingTable to the hand
+// or distribution; this is only consulted when none is given.
 extern const char **OmahaOrdering;
 
+class OrderingTable;
+struct ParseError;
+
 ///////////////////////////////////////////////////////////////////////////////
 // Single hands
 // To specify a single hand for example type AsQc7h3d
@@ -67,11 +71,13 @@ extern const char **OmahaOrdering;
 class OmahaAgnosticHand
 {
 public:
-  OmahaAgnosticHand();
+  OmahaAgnosticHand(const OrderingTable* ordering = NULL);
   ~OmahaAgnosticHand();
 
-  int Parse(const char* handText, const char* deadCards);
-  int Parse(const char* handText, StdDeck_CardMask deadCards);
+  // Returns 1 if the text is a valid hand or range. Errors are reported
+  // through error, when given, and never printed.
+  int Parse(const char* handText, const char* deadCards, ParseError* error = NULL);
+  int Parse(const char* handText, StdDeck_CardMask deadCards, ParseError* error = NULL);
 
   int Instantiate(const char* handText, const char* deadCards, vector<StdDeck_CardMask>& hands);
   int Instantiate(const char* handText, StdDeck_CardMask deadCards, vector<StdDeck_CardMask>& hands);
@@ -83,6 +89,7 @@ private:
   int InstantiateRandom(StdDeck_CardMask deadCards, vector<StdDeck_CardMask>& specificHands);
   void Reset();
   int InstantiatePercentRange(const char* handText, StdDeck_CardMask deadCards, vector<StdDeck_CardMask>& specificHands);
+  const OrderingTable* m_ordering;
   int m_rankFloor[4];
   int m_rankCeil[4];
   int m_suitFloor[4];
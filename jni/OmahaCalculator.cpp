@@ -0,0 +1,387 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <inlines/eval_omaha.h>
+#include "HandDistributions.h"
+#include "OmahaCalculator.h"
+#include "OmahaHandDistribution.h"
+#include "CardConverter.h"
+#include "EquityStatistics.h"
+#include "StratifiedSampler.h"
+#include "HandCompatibility.h"
+#include "RandomEngine.h"
+#include "HandDistMetrics.h"
+
+OmahaCalculator::OmahaCalculator(void)
+    : m_pDistributions(NULL), m_pOrdering(NULL), m_isHiLo(false), m_playerCount(0), m_trials(0), m_collisions(0),
+    m_targetError(0.0), m_timeLimit(0), m_pCancel(NULL),
+    m_engine(RandomEngine::Philox), m_seed(0), m_lastSeed(0), m_firstTrial(0), m_stratified(false)
+{
+    StdDeck_CardMask_RESET(m_dead);
+}
+
+OmahaCalculator::~OmahaCalculator(void)
+{
+    Clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Free the player distributions created by Init().
+///////////////////////////////////////////////////////////////////////////////
+void OmahaCalculator::Clear(void)
+{
+    OmahaHandDistribution* pDist = m_pDistributions;
+    while (pDist != NULL) {
+        OmahaHandDistribution* pNext = pDist->Next();
+        delete pDist;
+        pDist = pNext;
+    }
+
+    m_pDistributions = NULL;
+    m_playerCount = 0;
+    ClearMatrices();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Free the compatibility matrices built by Calculate(). They only depend on
+// the hands of the distributions, so they are kept for as long as Init()
+// keeps the same distributions.
+///////////////////////////////////////////////////////////////////////////////
+void OmahaCalculator::ClearMatrices(void)
+{
+    for (size_t i = 0; i < m_matrices.size(); i++)
+        delete m_matrices[i];
+    m_matrices.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Create one distribution per '|' separated player range, chained through
+// OmahaHandDistribution::m_pNext. Dead cards are removed from every
+// distribution when it is instantiated, board cards with SetDeadCards().
+//
+// A player's distribution from the previous call is kept when its range and
+// the dead cards are unchanged; only its alias table is rebuilt if the board
+// changed. Instantiating a random hand means building every hand in the deck,
+// which would otherwise dominate runs that simulate many hands or boards
+// against the same opponents.
+//
+// Returns the number of players, or 0 on a bad or empty range.
+///////////////////////////////////////////////////////////////////////////////
+int OmahaCalculator::Init(const char* hands, StdDeck_CardMask board, StdDeck_CardMask dead)
+{
+    StdDeck_CardMask excluded;
+    StdDeck_CardMask_OR(excluded, board, dead);
+
+    vector<OmahaHandDistribution*> previous;
+    if (StdDeck_CardMask_EQUAL(dead, m_dead)) {
+        for (OmahaHandDistribution* pDist = m_pDistributions; pDist != NULL; pDist = pDist->Next())
+            previous.push_back(pDist);
+    }
+    else {
+        Clear();
+    }
+    m_pDistributions = NULL;
+    m_playerCount = 0;
+    m_dead = dead;
+    bool reused = true;
+
+    string text(hands ? hands : "");
+    OmahaHandDistribution* pLast = NULL;
+    bool valid = true;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find('|', start);
+        if (end == string::npos)
+            end = text.size();
+
+        string range = text.substr(start, end - start);
+        OmahaHandDistribution* pDist = NULL;
+        if ((size_t)m_playerCount < previous.size()) {
+            pDist = previous[m_playerCount];
+            previous[m_playerCount] = NULL;
+            if (range != pDist->GetText() || pDist->GetOrdering() != m_pOrdering) {
+                delete pDist;
+                pDist = NULL;
+            }
+        }
+
+        if (pDist == NULL) {
+            reused = false;
+            pDist = new OmahaHandDistribution();
+            pDist->SetOrdering(m_pOrdering);
+            if (range.empty() || pDist->Init(range.c_str(), dead) <= 0)
+                valid = false;
+        }
+
+        if (valid && pDist->SetDeadCards(excluded) <= 0)
+            valid = false;
+
+        pDist->m_pNext = NULL;
+        if (pLast == NULL)
+            m_pDistributions = pDist;
+        else
+            pLast->m_pNext = pDist;
+        pLast = pDist;
+        m_playerCount++;
+
+        start = end + 1;
+    }
+
+    for (size_t i = 0; i < previous.size(); i++)
+        delete previous[i];
+
+    if (!reused || previous.size() != (size_t)m_playerCount)
+        ClearMatrices();
+
+    if (!valid) {
+        Clear();
+        return 0;
+    }
+
+    return m_playerCount;
+}
+
+int OmahaCalculator::Calculate(const char* hands, const char* board, const char* dead, int64_t numberOfTrials, double* results)
+{
+    return Calculate(hands, CardConverter::TextToPokerEval(board), CardConverter::TextToPokerEval(dead), numberOfTrials, results);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Run the simulation. The players' hands are dealt in turn from the hands of
+// their distribution that are compatible with the hands dealt before them.
+// A HandCompatibility matrix is built for every pair of ranges, as long as
+// they fit in COMPATIBILITY_BUDGET. Two plain draws are tried first; if both
+// collide the possible hands are the AND of the player's live hands and one
+// row per earlier player, and one is picked from those. Otherwise (several
+// wide ranges, such as XXXX against XXXX) hands are picked by trial and error
+// in OmahaHandDistribution::Choose. A trial in which some player has no hand
+// left is thrown out and counted as a collision.
+//
+// The run ends after numberOfTrials trials, or earlier when the target error
+// or time limit is reached or the run is cancelled; this is checked every
+// CHECK_INTERVAL trials so the clock isn't read on every one.
+///////////////////////////////////////////////////////////////////////////////
+static const size_t COMPATIBILITY_BUDGET = 64 << 20; // bytes
+
+int OmahaCalculator::Calculate(const char* hands, StdDeck_CardMask board, StdDeck_CardMask dead, int64_t numberOfTrials, double* results)
+{
+    m_trials = 0;
+    m_collisions = 0;
+    m_errors.clear();
+
+    if (Init(hands, board, dead) == 0)
+        return 0;
+    m_errors.assign(m_playerCount, 0.0);
+
+    StdDeck_CardMask used;
+    StdDeck_CardMask_OR(used, board, dead);
+
+    int boardCards = 0;
+    for (int card = 0; card < StdDeck_N_CARDS; card++) {
+        if (StdDeck_CardMask_CARD_IS_SET(board, card))
+            boardCards++;
+    }
+
+    vector<OmahaHandDistribution*> dists;
+    for (OmahaHandDistribution* pDist = m_pDistributions; pDist != NULL; pDist = pDist->Next())
+        dists.push_back(pDist);
+
+    size_t footprint = 0;
+    for (int prior = 0; prior < m_playerCount; prior++) {
+        for (int player = prior + 1; player < m_playerCount; player++)
+            footprint += HandCompatibility::GetFootprint(dists[prior]->GetCount(), dists[player]->GetCount());
+    }
+
+    // m_matrices[prior * m_playerCount + player]: rows are prior's hands
+    bool useBitsets = (footprint <= COMPATIBILITY_BUDGET);
+    m_matrices.resize(m_playerCount * m_playerCount, (HandCompatibility*)NULL);
+    vector< vector<uint64_t> > live(m_playerCount);
+    if (useBitsets) {
+        for (int player = 0; player < m_playerCount; player++) {
+            live[player].resize((dists[player]->GetCount() + 63) / 64, 0);
+            for (int i = 0; i < dists[player]->GetCount(); i++) {
+                if (!StdDeck_CardMask_ANY_SET(dists[player]->Get(i), used))
+                    live[player][i >> 6] |= (uint64_t)1 << (i & 63);
+            }
+            for (int prior = 0; prior < player; prior++) {
+                HandCompatibility*& matrix = m_matrices[prior * m_playerCount + player];
+                if (matrix == NULL)
+                    matrix = new HandCompatibility(dists[prior]->m_hands, dists[player]->m_hands);
+            }
+        }
+    }
+
+    vector<double> shares(m_playerCount);
+    EquityStatistics stats(m_playerCount, m_targetError, m_timeLimit);
+    vector<StdDeck_CardMask> holeCards(m_playerCount);
+    vector<HandVal> handValues(m_playerCount);
+    vector<LowHandVal> lowValues(m_playerCount, LowHandVal_NOTHING);
+    vector<int> chosen(m_playerCount);
+    vector<uint64_t> possible;
+    m_lastSeed = m_seed ? m_seed : RandomEngine::NewSeed();
+    RandomEngine* pEngine = RandomEngine::Create(m_engine, m_lastSeed);
+    if (pEngine == NULL)
+        return 0;
+    RandomEngine& rand = *pEngine;
+
+    // Stratified mode draws its orders and shifts from a stream of its own
+    StratifiedSampler sampler;
+    if (m_stratified) {
+        for (OmahaHandDistribution* pDist = m_pDistributions; pDist != NULL; pDist = pDist->Next()) {
+            vector<int> hands;
+            vector<double> handWeights;
+            for (int i = 0; i < pDist->GetCount(); i++) {
+                if (StdDeck_CardMask_ANY_SET(pDist->Get(i), used) || pDist->GetWeight(i) <= 0.0)
+                    continue;
+                hands.push_back(i);
+                if (pDist->IsWeighted())
+                    handWeights.push_back(pDist->GetWeight(i));
+            }
+            sampler.AddPlayer(hands, handWeights);
+        }
+        rand.Seek(~(uint64_t)0);
+        sampler.Init(rand);
+    }
+
+    for (int64_t trial = 0; trial < numberOfTrials; trial++) {
+        if (trial % EquityStatistics::CHECK_INTERVAL == 0 && trial > 0 && (stats.IsDone() || (m_pCancel != NULL && *m_pCancel)))
+            break;
+
+        rand.Seek(m_firstTrial + trial);
+        StdDeck_CardMask trialDead = used;
+        bool bCollision = false;
+
+        int player = 0;
+        for (OmahaHandDistribution* pDist = m_pDistributions; pDist != NULL; pDist = pDist->Next(), player++) {
+            // The stratified pick, then a couple of plain draws: wide
+            // ranges rarely collide
+            chosen[player] = -1;
+            if (m_stratified) {
+                int i = sampler.Hand(player, m_firstTrial + trial);
+                if (i >= 0 && !StdDeck_CardMask_ANY_SET(pDist->Get(i), trialDead))
+                    chosen[player] = i;
+            }
+            for (int attempt = 0; useBitsets && attempt < 2 && chosen[player] < 0; attempt++) {
+                int i = pDist->Sample(rand);
+                if (!StdDeck_CardMask_ANY_SET(pDist->Get(i), trialDead))
+                    chosen[player] = i;
+            }
+
+            if (chosen[player] >= 0) {
+                holeCards[player] = pDist->Get(chosen[player]);
+            }
+            else if (useBitsets) {
+                possible = live[player];
+                int words = possible.size();
+                for (int prior = 0; prior < player; prior++) {
+                    const uint64_t* row = m_matrices[prior * m_playerCount + player]->Row(chosen[prior]);
+                    for (int w = 0; w < words; w++)
+                        possible[w] &= row[w];
+                }
+
+                chosen[player] = HandCompatibility::Choose(&possible[0], words, pDist->m_weights, pDist->m_alias, NULL, rand);
+                if (chosen[player] < 0) {
+                    bCollision = true;
+                    break;
+                }
+                holeCards[player] = pDist->Get(chosen[player]);
+            }
+            else {
+                holeCards[player] = pDist->Choose(trialDead, bCollision, rand);
+                if (bCollision || StdDeck_CardMask_ANY_SET(holeCards[player], trialDead)) {
+                    bCollision = true;
+                    break;
+                }
+            }
+            StdDeck_CardMask_OR(trialDead, trialDead, holeCards[player]);
+        }
+
+        if (bCollision) {
+            m_collisions++;
+            continue;
+        }
+
+        // Deal out the rest of the board
+        StdDeck_CardMask trialBoard = board;
+        if (m_stratified)
+            sampler.DealBoard(m_firstTrial + trial, 5 - boardCards, trialDead, trialBoard);
+        for (int dealt = m_stratified ? 5 : boardCards; dealt < 5; ) {
+            int card = rand.Below(StdDeck_N_CARDS);
+            if (StdDeck_CardMask_CARD_IS_SET(trialDead, card))
+                continue;
+            StdDeck_CardMask_SET(trialDead, card);
+            StdDeck_CardMask_SET(trialBoard, card);
+            dealt++;
+        }
+
+        HandVal bestHi = 0;
+        LowHandVal bestLo = LowHandVal_NOTHING;
+        int hiWinners = 0, loWinners = 0;
+        for (player = 0; player < m_playerCount; player++) {
+            if (m_isHiLo)
+                StdDeck_OmahaHiLow8_EVAL(holeCards[player], trialBoard, &handValues[player], &lowValues[player]);
+            else
+                StdDeck_OmahaHi_EVAL(holeCards[player], trialBoard, &handValues[player]);
+
+            if (hiWinners == 0 || handValues[player] > bestHi) {
+                bestHi = handValues[player];
+                hiWinners = 1;
+            }
+            else if (handValues[player] == bestHi) {
+                hiWinners++;
+            }
+
+            if (m_isHiLo && lowValues[player] != LowHandVal_NOTHING) {
+                if (loWinners == 0 || lowValues[player] < bestLo) {
+                    bestLo = lowValues[player];
+                    loWinners = 1;
+                }
+                else if (lowValues[player] == bestLo) {
+                    loWinners++;
+                }
+            }
+        }
+
+        // Half the pot goes to the low if there is one, otherwise high scoops
+        double hiPot = loWinners ? 0.5 : 1.0;
+        for (player = 0; player < m_playerCount; player++) {
+            shares[player] = 0.0;
+            if (handValues[player] == bestHi)
+                shares[player] += hiPot / hiWinners;
+            if (loWinners && lowValues[player] == bestLo)
+                shares[player] += 0.5 / loWinners;
+        }
+
+        stats.Add(&shares[0]);
+        m_trials++;
+    }
+
+    HANDDIST_COUNT(Trials, m_trials);
+    HANDDIST_COUNT(TrialCollisions, m_collisions);
+
+    for (int player = 0; player < m_playerCount; player++) {
+        results[player] = stats.GetMean(player);
+        m_errors[player] = stats.GetStandardError(player);
+    }
+
+    delete pEngine;
+    return m_playerCount;
+}
@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+class OmahaHandDistribution;
+class OrderingTable;
+class HandCompatibility;
+
+///////////////////////////////////////////////////////////////////////////////
+// Monte Carlo equity calculator for Omaha high and Omaha high/low 8 or
+// better. Each player is given a distribution (a specific hand such as
+// "AhKhQdJd" or a range such as "[AK][AK],QQxx"); the player distributions
+// are separated by '|':
+//
+//			"[AK][AK]|QQxx/ds|XXXX"
+//
+// For every trial each distribution chooses one of its hands, the rest of the
+// board is dealt at random and the pot is awarded to the best hand(s). In
+// high/low the pot is split between the best high and the best qualifying
+// low, and the high hand scoops when there is no low.
+///////////////////////////////////////////////////////////////////////////////
+class OmahaCalculator
+{
+public:
+	OmahaCalculator();
+	virtual ~OmahaCalculator(void);
+
+	// Returns the number of players, or 0 if a range could not be parsed or
+	// is empty. On success results[i] holds player i's equity (0..1).
+	int Calculate(const char* hands, const char* board, const char* dead, int64_t numberOfTrials, double* results);
+	int Calculate(const char* hands, StdDeck_CardMask board, StdDeck_CardMask dead, int64_t numberOfTrials, double* results);
+
+	// Ordering table used for percent ranges; NULL selects the default.
+	void SetOrdering(const OrderingTable* ordering) { m_pOrdering = ordering; }
+
+	// Play Omaha high/low 8 or better instead of Omaha high.
+	void SetHiLo(bool hiLo) { m_isHiLo = hiLo; }
+	bool IsHiLo() const { return m_isHiLo; }
+
+	// Stop a simulation early once every player's standard error is at most
+	// targetError, or once timeLimit milliseconds have passed; 0 turns a rule
+	// off. The numberOfTrials given to Calculate() stays the upper bound.
+	void SetTargetError(double targetError) { m_targetError = targetError; }
+	void SetTimeLimit(int64_t timeLimit) { m_timeLimit = timeLimit; }
+
+	// Stop a simulation as soon as *cancel becomes true (checked with the
+	// stopping rules); the results cover the trials run so far. NULL clears.
+	void SetCancel(const atomic<bool>* cancel) { m_pCancel = cancel; }
+
+	// Trial i of a run deals from stream firstTrial + i of the seed, so a run
+	// with the same seed, inputs and trial numbers deals the same cards (see
+	// RandomEngine for the engines that can't). Seed 0 (the default) picks a
+	// new seed for every run; GetSeed() returns the seed of the last run
+	// either way. Trials that collide keep their number.
+	void SetEngine(int engine) { m_engine = engine; }
+	void SetSeed(uint64_t seed) { m_seed = seed; }
+	uint64_t GetSeed() const { return m_lastSeed; }
+	void SetFirstTrial(int64_t firstTrial) { m_firstTrial = firstTrial; }
+
+	// Deal hands and boards from a StratifiedSampler rather than at random.
+	// Equities converge faster; the standard errors are still computed as
+	// for independent trials, so they overstate the actual error.
+	void SetStratified(bool stratified) { m_stratified = stratified; }
+
+	// Standard error of player's equity from the last run, 0 when it was
+	// exact: results[player] +/- 1.96 * error is a 95% confidence interval.
+	double GetStandardError(int player) const { return (size_t)player < m_errors.size() ? m_errors[player] : 0.0; }
+
+	int GetPlayerCount() const { return m_playerCount; }
+	int64_t GetTrials() const { return m_trials; }
+	int64_t GetCollisions() const { return m_collisions; }
+
+private:
+	int Init(const char* hands, StdDeck_CardMask board, StdDeck_CardMask dead);
+	void Clear();
+	void ClearMatrices();
+
+	OmahaHandDistribution* m_pDistributions;
+	vector<HandCompatibility*> m_matrices;
+	const OrderingTable* m_pOrdering;
+	bool m_isHiLo;
+	int m_playerCount;
+	int64_t m_trials;
+	int64_t m_collisions;
+	double m_targetError;
+	int64_t m_timeLimit;
+	const atomic<bool>* m_pCancel;
+	int m_engine;
+	uint64_t m_seed;
+	uint64_t m_lastSeed;
+	int64_t m_firstTrial;
+	bool m_stratified;
+	vector<double> m_errors;
+	StdDeck_CardMask m_dead;
+};
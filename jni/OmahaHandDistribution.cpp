@@ -21,16 +21,23 @@
 
 #include "HandDistributions.h"
 #include <inlines/eval_omaha.h>
+#include <cmath>
 
 #include "OmahaHandDistribution.h"
 #include "OmahaAgnosticHand.h"
+#include "HandBitset.h"
 #include "CardConverter.h"
-#include "mtrand.h"
+#include "RandomEngine.h"
+#include "HandDistMetrics.h"
+#include "RangeCache.h"
+
+static const char* const EXPECT_WEIGHT = "a weight such as 0.5";
 
 ///////////////////////////////////////////////////////////////////////////////
 // Default constructor for OmahaHandDistribution objects. No-op.
 ///////////////////////////////////////////////////////////////////////////////
 OmahaHandDistribution::OmahaHandDistribution(void)
+    : m_pNext(NULL), m_pOrdering(NULL), m_aliasValid(false), m_liveCount(0)
 {
 
 }
@@ -42,6 +49,7 @@ OmahaHandDistribution::OmahaHandDistribution(void)
 // Hold'em hand ("AhKhQhJh") or a hand range/distribution ("[A2]+22+").
 ///////////////////////////////////////////////////////////////////////////////
 OmahaHandDistribution::OmahaHandDistribution(const char* hand)
+    : m_pNext(NULL), m_pOrdering(NULL), m_aliasValid(false), m_liveCount(0)
 {
 	Init(hand);
 }
@@ -53,6 +61,19 @@ OmahaHandDistribution::OmahaHandDistribution(const char* hand)
 // excluded from whatever distribution we create.
 ///////////////////////////////////////////////////////////////////////////////
 OmahaHandDistribution::OmahaHandDistribution(const char* hand, StdDeck_CardMask deadCards)
+    : m_pNext(NULL), m_pOrdering(NULL), m_aliasValid(false), m_liveCount(0)
+{
+	Init(hand, deadCards);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// As above, but resolve percent ranges ("15%") against the given ordering
+// table, e.g. OrderingTables::Get(OrderingTables::Omaha6Max).
+///////////////////////////////////////////////////////////////////////////////
+OmahaHandDistribution::OmahaHandDistribution(const char* hand, StdDeck_CardMask deadCards, const OrderingTable* ordering)
+    : m_pNext(NULL), m_pOrdering(ordering), m_aliasValid(false), m_liveCount(0)
 {
 	Init(hand, deadCards);
 }
@@ -89,17 +110,50 @@ int OmahaHandDistribution::Init(const char* hand)
 ///////////////////////////////////////////////////////////////////////////////
 int OmahaHandDistribution::Init(const char* hand, StdDeck_CardMask deadCards)
 {
+	HANDDIST_TIMER(initTimer, InitTime);
+
+	// A range built by an earlier run, if there is a RangeCache
+	bool cacheable = m_hands.empty() && RangeCache::IsEnabled();
+	if (cacheable && RangeCache::Load(hand, deadCards, *this)) {
+		HANDDIST_COUNT(InitCalls, 1);
+		HANDDIST_RECORD(RangeHands, m_hands.size());
+		return m_hands.size();
+	}
+
 	m_handText = hand;
+	m_error.Clear();
 
 	char* handCopy = strdup(hand);
 
-	char* pElem = strtok(handCopy, ",");
+	m_weights.resize(m_hands.size(), 1.0);
+
+	char* pText = handCopy;
+	char* pElem = HandBitset::NextTerm(pText);
 	while (pElem != NULL)
 	{
-	  OmahaAgnosticHand omahaAgnosticHand;
-	  if (omahaAgnosticHand.Parse(pElem, deadCards)) {
+	  int start = (int)(pElem - handCopy);
+	  double weight = SplitWeight(pElem);
+	  OmahaAgnosticHand omahaAgnosticHand(m_pOrdering);
+	  if (weight < 0.0) {
+	    // SplitWeight() has cut the term at its colon
+	    m_error.Set(ParseError::BadWeight, start + (int)strlen(pElem) + 1, EXPECT_WEIGHT);
+	    free(handCopy);
+	    return 0;
+	  }
+	  else if (HandBitset::IsExpression(pElem)) {
+	    HANDDIST_TIMER(termTimer, InstantiateExpressionTime);
+	    HandBitset expression(OMAHA_MAXHOLE);
+	    if (!HandBitset::Evaluate(pElem, ExpandOperand, this, expression)) {
+	      CheckTerm(pElem, start, m_error);
+	      free(handCopy);
+	      return 0;
+	    }
+	    expression.GetHands(deadCards, m_hands);
+	  }
+	  else if (omahaAgnosticHand.Parse(pElem, deadCards, &m_error)) {
 	    if (omahaAgnosticHand.IsSpecificHand(pElem))
 	      {
+		HANDDIST_TIMER(termTimer, InstantiateSpecificTime);
 		m_current = CardConverter::TextToPokerEval(pElem);
 		m_hands.push_back(m_current);
 	      }
@@ -109,22 +163,34 @@ int OmahaHandDistribution::Init(const char* hand, StdDeck_CardMask deadCards)
 	      }
 	  }
 	  else {
+	    m_error.Shift(start);
+	    free(handCopy);
 	    return 0;
 	  }
+	  m_weights.resize(m_hands.size(), weight);
 
-
-	  pElem = strtok(NULL, ",");
+	  pElem = HandBitset::NextTerm(pText);
 	}
 
 	free(handCopy);
 
 	// Now we need to remove duplicate elements from the array
 
-	std::sort( m_hands.begin(), m_hands.end(), CardMaskGreaterThan );
-	std::vector<StdDeck_CardMask>::iterator new_end_pos;
-	new_end_pos = std::unique( m_hands.begin(), m_hands.end(), CardMaskEqual );
-	m_hands.erase( new_end_pos, m_hands.end() );
+	RemoveDuplicates();
+
+	// Weighted distributions are sampled through the alias table
+	m_aliasValid = false;
+	SetDeadCards(deadCards);
 
+	// A unary distribution always "chooses" m_current
+	if (m_hands.size() == 1)
+		m_current = m_hands[0];
+
+	if (cacheable)
+		RangeCache::Store(hand, deadCards, *this);
+
+	HANDDIST_COUNT(InitCalls, 1);
+	HANDDIST_RECORD(RangeHands, m_hands.size());
 	return m_hands.size();
 }
 
@@ -139,19 +205,36 @@ int OmahaHandDistribution::Init(const char* hand, StdDeck_CardMask deadCards)
 // shouldn't be allowed to "choose" any hand containing the As or the Ks.
 ///////////////////////////////////////////////////////////////////////////////
 StdDeck_CardMask OmahaHandDistribution::Choose(StdDeck_CardMask deadCards, bool& bCollisionError)
+{
+	// Callers that don't deal trial by trial from their own generator
+	static thread_local PhiloxEngine rand(RandomEngine::NewSeed());
+	return Choose(deadCards, bCollisionError, rand);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Same as above, drawing from the caller's generator.
+///////////////////////////////////////////////////////////////////////////////
+StdDeck_CardMask OmahaHandDistribution::Choose(StdDeck_CardMask deadCards, bool& bCollisionError, RandomEngine& rand)
 {
 	if (IsUnary())
 		return m_current;
 
-	MTRand53 rand;
 	StdDeck_CardMask nullHand;
 	StdDeck_CardMask_RESET(nullHand);
 	int handCount = m_hands.size();
 	bCollisionError = false;
+	HANDDIST_COUNT(ChooseCalls, 1);
 
 	if (handCount <= 0)
 	  return nullHand;
 
+	// Every hand is blocked by the dead cards given to SetDeadCards()
+	if (m_liveCount == 0) {
+	  HANDDIST_COUNT(ChooseCollisions, 1);
+	  bCollisionError = true;
+	  return nullHand;
+	}
+
 	// This is a little bit of a hack. So this OmahaHandDistribution has N potential
 	// hands and we'll choose one of these randomly for each trial. Fine. But it's
 	// possible that some of these N hands are now impossible, because of the cards
@@ -163,7 +246,8 @@ StdDeck_CardMask OmahaHandDistribution::Choose(StdDeck_CardMask deadCards, bool&
 
 	for (int attempt = 0; attempt < 10; attempt++)
 	{
-		int randVal = rand.under(handCount);
+		HANDDIST_COUNT(ChooseAttempts, 1);
+		int randVal = m_alias.IsEmpty() ? rand.Below(handCount) : m_alias.Sample(rand);
 		StdDeck_CardMask randHand = m_hands[randVal];
 
 		if (!StdDeck_CardMask_ANY_SET(randHand, deadCards))
@@ -181,11 +265,246 @@ StdDeck_CardMask OmahaHandDistribution::Choose(StdDeck_CardMask deadCards, bool&
 	// are used elsewhere. In this case, since it happens so rarely, we want to
 	// throw the entire trial out.
 
+	HANDDIST_COUNT(ChooseCollisions, 1);
 	bCollisionError = true;
 	return nullHand;
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// Draw the index of one of the hands, by weight. Unlike Choose() this doesn't
+// look at dead cards other than those given to SetDeadCards(), so the caller
+// has to check the hand.
+///////////////////////////////////////////////////////////////////////////////
+int OmahaHandDistribution::Sample(RandomEngine& rand) const
+{
+	if (m_hands.size() <= 1)
+		return 0;
+
+	return m_alias.IsEmpty() ? rand.Below(m_hands.size()) : m_alias.Sample(rand);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Remove hands colliding with the given dead cards (board cards, for example)
+// from the hands Choose() can return, without instantiating the distribution
+// again. Weighted distributions and distributions with blocked hands are
+// sampled through an alias table, which is only rebuilt when the dead cards
+// change. Returns the number of hands that can still be chosen.
+///////////////////////////////////////////////////////////////////////////////
+int OmahaHandDistribution::SetDeadCards(StdDeck_CardMask deadCards)
+{
+	if (m_aliasValid && StdDeck_CardMask_EQUAL(deadCards, m_aliasDead))
+		return m_liveCount;
+
+	m_aliasDead = deadCards;
+	m_aliasValid = true;
+
+	vector<double> weights(m_hands.size());
+	bool blocked = false;
+	for (size_t i = 0; i < m_hands.size(); i++) {
+		if (StdDeck_CardMask_ANY_SET(m_hands[i], deadCards)) {
+			weights[i] = 0.0;
+			blocked = true;
+		}
+		else {
+			weights[i] = GetWeight(i);
+		}
+	}
+
+	if (!blocked && m_weights.empty()) {
+		m_alias.Clear();
+		m_liveCount = m_hands.size();
+	}
+	else {
+		m_liveCount = m_alias.Build(weights);
+	}
+
+	return m_liveCount;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// HandBitset::Evaluate() callback: expand one operand of a range expression
+// ("[AK]xx", "AAxx", "15%", "AsKsQhJh"...). Dead cards are left in and
+// removed once the whole expression has been evaluated, so that "!AAxx"
+// means every hand without two aces.
+///////////////////////////////////////////////////////////////////////////////
+bool OmahaHandDistribution::ExpandOperand(const char* operand, HandBitset& hands, void* context)
+{
+	OmahaHandDistribution* pThis = (OmahaHandDistribution*)context;
+	StdDeck_CardMask noDead;
+	StdDeck_CardMask_RESET(noDead);
+
+	OmahaAgnosticHand omahaAgnosticHand(pThis->m_pOrdering);
+	if (!omahaAgnosticHand.Parse(operand, noDead))
+		return false;
+
+	vector<StdDeck_CardMask> expanded;
+	if (omahaAgnosticHand.IsSpecificHand(operand))
+		expanded.push_back(CardConverter::TextToPokerEval(operand));
+	else
+		omahaAgnosticHand.Instantiate(operand, noDead, expanded);
+
+	hands.Set(expanded);
+	return true;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// HandBitset::CheckExpression() callback: the syntax of one operand, whose
+// error, if any, goes into the ParseError passed as context.
+///////////////////////////////////////////////////////////////////////////////
+bool OmahaHandDistribution::CheckOperand(const char* operand, void* context)
+{
+	StdDeck_CardMask noDead;
+	StdDeck_CardMask_RESET(noDead);
+
+	OmahaAgnosticHand omahaAgnosticHand;
+	return omahaAgnosticHand.Parse(operand, noDead, (ParseError*)context) != 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Check one term of a range, without its weight, that starts at offset start
+// of the range's text. Returns false, with the error recorded, if it is
+// malformed.
+///////////////////////////////////////////////////////////////////////////////
+bool OmahaHandDistribution::CheckTerm(const char* term, int start, ParseError& error)
+{
+	ParseError termError;
+	if (HandBitset::IsExpression(term)) {
+		const char* expected;
+		const char* errorAt = HandBitset::CheckExpression(term, CheckOperand, &termError, expected);
+		if (errorAt == NULL)
+			return true;
+		// An operand's error is relative to the operand
+		termError.Set(ParseError::BadExpression, 0, expected);
+		termError.Shift((int)(errorAt - term));
+	}
+	else if (CheckOperand(term, &termError)) {
+		return true;
+	}
+
+	termError.Shift(start);
+	error.Set(termError.code, termError.offset, termError.expected);
+	return false;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// The syntax of every term of the range, as Init() would parse it, but
+// nothing is instantiated, sorted or printed.
+///////////////////////////////////////////////////////////////////////////////
+bool OmahaHandDistribution::Validate(const char* hand, ParseError* error)
+{
+	ParseError localError;
+	ParseError& result = error != NULL ? *error : localError;
+	result.Clear();
+
+	string text(hand);
+	char* pText = &text[0];
+	char* pElem = HandBitset::NextTerm(pText);
+	if (pElem == NULL) {
+		result.Set(ParseError::MissingCards, 0, "a hand or range");
+		return false;
+	}
+
+	while (pElem != NULL) {
+		int start = (int)(pElem - text.c_str());
+		if (SplitWeight(pElem) < 0.0) {
+			result.Set(ParseError::BadWeight, start + (int)strlen(pElem) + 1, EXPECT_WEIGHT);
+			return false;
+		}
+		if (!CheckTerm(pElem, start, result))
+			return false;
+		pElem = HandBitset::NextTerm(pText);
+	}
+
+	return true;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Strip an optional ":<weight>" suffix ("AKs:0.25") from a range element and
+// return the weight, 1 if there is none or -1 if it is not a valid weight.
+// Omaha uses ":<n>" for rank gaps, so a weight must contain a
+// decimal point ("[AK]xx:0.5", "AAxx:1.0"); anything else is left in place
+// for the parser. Infinite and NaN weights ("AAxx:1.0e999") are not valid.
+///////////////////////////////////////////////////////////////////////////////
+double OmahaHandDistribution::SplitWeight(char* pElem)
+{
+	char* pColon = strrchr(pElem, ':');
+	if (pColon == NULL || strchr(pColon, '.') == NULL)
+		return 1.0;
+
+	char* pEnd = NULL;
+	double weight = strtod(pColon + 1, &pEnd);
+	if (pEnd == pColon + 1 || *pEnd != '\0')
+		return 1.0;
+
+	*pColon = '\0';
+	return std::isfinite(weight) && weight >= 0.0 ? weight : -1.0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Sort the distribution and remove duplicate hands, along with hands whose
+// weight is zero. A hand listed more than once keeps its largest weight. If
+// every remaining hand has a weight of 1 the weights are dropped and the
+// distribution is sampled uniformly again.
+///////////////////////////////////////////////////////////////////////////////
+void OmahaHandDistribution::RemoveDuplicates()
+{
+	HANDDIST_TIMER(dedupeTimer, DedupeTime);
+	bool uniform = true;
+	for (size_t i = 0; i < m_weights.size() && uniform; i++)
+		uniform = (m_weights[i] == 1.0);
+
+	if (uniform) {
+		std::sort( m_hands.begin(), m_hands.end(), CardMaskGreaterThan );
+		std::vector<StdDeck_CardMask>::iterator new_end_pos;
+		new_end_pos = std::unique( m_hands.begin(), m_hands.end(), CardMaskEqual );
+		m_hands.erase( new_end_pos, m_hands.end() );
+		m_weights.clear();
+		return;
+	}
+
+	vector<int> order(m_hands.size());
+	for (size_t i = 0; i < order.size(); i++)
+		order[i] = i;
+
+	std::sort(order.begin(), order.end(), [this](int a, int b) {
+		if (!CardMaskEqual(m_hands[a], m_hands[b]))
+			return CardMaskGreaterThan(m_hands[a], m_hands[b]);
+		return m_weights[a] > m_weights[b];
+	});
+
+	vector<StdDeck_CardMask> hands;
+	vector<double> weights;
+	uniform = true;
+	for (size_t i = 0; i < order.size(); i++) {
+		int index = order[i];
+		if (m_weights[index] <= 0.0)
+			continue;
+		if (!hands.empty() && CardMaskEqual(hands.back(), m_hands[index]))
+			continue;
+		hands.push_back(m_hands[index]);
+		weights.push_back(m_weights[index]);
+		if (m_weights[index] != 1.0)
+			uniform = false;
+	}
+
+	m_hands.swap(hands);
+	m_weights.swap(weights);
+	if (uniform)
+		m_weights.clear();
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Used by std::sort when we sort the distribution prior to removing duplicate
 // hands from the distribution.
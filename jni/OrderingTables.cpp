@@ -0,0 +1,316 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <climits>
+#include <inlines/eval_omaha.h>
+#include "HandDistributions.h"
+#include "OrderingTables.h"
+#include "HoldemAgnosticHand.h"
+#include "OmahaAgnosticHand.h"
+
+// The ordering arrays are defined (not just declared) in these headers, so
+// this must remain the only translation unit that includes them.
+//
+// Define HANDDIST_EXTERNAL_OMAHA_ORDERINGS to leave the four 16,432 entry
+// Omaha tables out of the library; they must then be loaded at startup with
+// OrderingTables::Load() from files written by OrderingTables::Save().
+#include "he6maxordering.h"
+#include "he10maxordering.h"
+#ifndef HANDDIST_EXTERNAL_OMAHA_ORDERINGS
+#include "oh6maxordering.h"
+#include "oh10maxordering.h"
+#include "o86maxordering.h"
+#include "o810maxordering.h"
+#endif
+
+#define ORDERING_SIZE(table) ((int)(sizeof(table)/sizeof(const char *)))
+
+///////////////////////////////////////////////////////////////////////////////
+// Wrap a static array of hand classes. The table does not own the entries.
+///////////////////////////////////////////////////////////////////////////////
+OrderingTable::OrderingTable(const char* name, const char** entries, int size)
+    : m_name(name), m_entries(entries), m_offsets(NULL), m_blob(NULL), m_size(size)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Wrap the offsets and string blob of a mapped ordering file.
+///////////////////////////////////////////////////////////////////////////////
+OrderingTable::OrderingTable(const char* name, const uint32_t* offsets, const char* blob, int size)
+    : m_name(name), m_entries(NULL), m_offsets(offsets), m_blob(blob), m_size(size)
+{
+}
+
+OrderingTable::~OrderingTable(void)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Sort the table positions by entry text so that IndexOf() is a binary search
+// rather than a scan over 16,432 Omaha classes.
+///////////////////////////////////////////////////////////////////////////////
+void OrderingTable::BuildIndex(void) const
+{
+    m_sortedIndex.resize(m_size);
+    for (int i = 0; i < m_size; i++)
+        m_sortedIndex[i] = i;
+
+    const OrderingTable* table = this;
+    std::stable_sort(m_sortedIndex.begin(), m_sortedIndex.end(),
+        [table](int a, int b) { return strcmp(table->Get(a), table->Get(b)) < 0; });
+}
+
+int OrderingTable::IndexOf(const char* entry) const
+{
+    std::call_once(m_indexOnce, &OrderingTable::BuildIndex, this);
+
+    const OrderingTable* table = this;
+    vector<int>::const_iterator it = std::lower_bound(m_sortedIndex.begin(), m_sortedIndex.end(), entry,
+        [table](int a, const char* text) { return strcmp(table->Get(a), text) < 0; });
+
+    if (it != m_sortedIndex.end() && strcmp(Get(*it), entry) == 0)
+        return *it;
+
+    return -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// A percent slice 10-25% of a table of N entries covers the entries from
+// (10 * N)/100 up to but not including (25 * N)/100.
+///////////////////////////////////////////////////////////////////////////////
+void OrderingTable::Slice(double lowerPercent, double upperPercent, int& first, int& last) const
+{
+    first = (int)((lowerPercent * m_size)/100.0);
+    last = (int)((upperPercent * m_size)/100.0);
+
+    if (first < 0) first = 0;
+    if (last > m_size) last = m_size;
+    if (last < first) last = first;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The built-in tables, in OrderingTables::Id order. Held in a function local
+// static so they are usable from other translation units' static initializers.
+///////////////////////////////////////////////////////////////////////////////
+static const OrderingTable* BuiltinTables(void)
+{
+    static const OrderingTable tables[OrderingTables::BuiltinCount] =
+    {
+        { "he6", HOLDEM_6_MAX_ORDERING, ORDERING_SIZE(HOLDEM_6_MAX_ORDERING) },
+        { "he10", HOLDEM_10_MAX_ORDERING, ORDERING_SIZE(HOLDEM_10_MAX_ORDERING) },
+#ifndef HANDDIST_EXTERNAL_OMAHA_ORDERINGS
+        { "oh6", OMAHA_6_MAX_ORDERING, ORDERING_SIZE(OMAHA_6_MAX_ORDERING) },
+        { "oh10", OMAHA_10_MAX_ORDERING, ORDERING_SIZE(OMAHA_10_MAX_ORDERING) },
+        { "o86", OMAHA8_6_MAX_ORDERING, ORDERING_SIZE(OMAHA8_6_MAX_ORDERING) },
+        { "o810", OMAHA8_10_MAX_ORDERING, ORDERING_SIZE(OMAHA8_10_MAX_ORDERING) }
+#else
+        { "oh6", (const char**)NULL, 0 },
+        { "oh10", (const char**)NULL, 0 },
+        { "o86", (const char**)NULL, 0 },
+        { "o810", (const char**)NULL, 0 }
+#endif
+    };
+
+    return tables;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Tables registered by Load(). They are never unloaded, so the pointers
+// handed out stay valid for the life of the process.
+///////////////////////////////////////////////////////////////////////////////
+static mutex s_loadedLock;
+static vector<const OrderingTable*> s_loadedTables;
+
+const OrderingTable* OrderingTables::FindLoaded(const char* name)
+{
+    lock_guard<mutex> lock(s_loadedLock);
+
+    // most recently loaded wins
+    for (size_t i = s_loadedTables.size(); i > 0; i--) {
+        if (strcmp(s_loadedTables[i-1]->GetName(), name) == 0)
+            return s_loadedTables[i-1];
+    }
+
+    return NULL;
+}
+
+const OrderingTable* OrderingTables::Get(int id)
+{
+    if (id < 0 || id >= BuiltinCount)
+        return NULL;
+
+    return Find(BuiltinTables()[id].GetName());
+}
+
+const OrderingTable* OrderingTables::Find(const char* name)
+{
+    if (name == NULL)
+        return NULL;
+
+    const OrderingTable* loaded = FindLoaded(name);
+    if (loaded != NULL)
+        return loaded;
+
+    const OrderingTable* tables = BuiltinTables();
+    for (int i = 0; i < BuiltinCount; i++) {
+        if (tables[i].GetSize() > 0 && strcmp(tables[i].GetName(), name) == 0)
+            return &tables[i];
+    }
+
+    return NULL;
+}
+
+const OrderingTable* OrderingTables::FindByEntries(const char** entries)
+{
+    const OrderingTable* tables = BuiltinTables();
+    for (int i = 0; i < BuiltinCount; i++) {
+        if (tables[i].GetEntries() == entries && tables[i].GetSize() > 0)
+            return &tables[i];
+    }
+
+    return NULL;
+}
+
+const OrderingTable* OrderingTables::DefaultHoldem(void)
+{
+    const OrderingTable* table = HoldemOrdering ? FindByEntries(HoldemOrdering) : NULL;
+    return table ? table : Get(Holdem10Max);
+}
+
+const OrderingTable* OrderingTables::DefaultOmaha(void)
+{
+    const OrderingTable* table = OmahaOrdering ? FindByEntries(OmahaOrdering) : NULL;
+    return table ? table : Get(Omaha10Max);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Map a binary ordering file and register it. Everything in the file is
+// checked before the table is handed out: offsets must be increasing, inside
+// the blob, and every entry must be NUL terminated.
+///////////////////////////////////////////////////////////////////////////////
+const OrderingTable* OrderingTables::Load(const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(OrderingFileHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t length = (size_t)st.st_size;
+    void* base = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file referenced
+    if (base == MAP_FAILED)
+        return NULL;
+
+    const OrderingFileHeader* header = (const OrderingFileHeader*)base;
+    const uint32_t* offsets = (const uint32_t*)(header + 1);
+    const char* blob = NULL;
+
+    // The version also tells a file of the other byte order, in which it
+    // reads byte-swapped
+    bool valid = (memcmp(header->magic, ORDERING_FILE_MAGIC, 4) == 0 &&
+                  header->version == ORDERING_FILE_VERSION &&
+                  header->count > 0 &&
+                  memchr(header->name, '\0', sizeof(header->name)) != NULL);
+
+    // In 64 bits, so that a huge count or blob size can't wrap around to
+    // the size of the file
+    if (valid) {
+        uint64_t count = header->count;
+        uint64_t expected = (uint64_t)sizeof(OrderingFileHeader) + (count + 1) * sizeof(uint32_t) + header->blobSize;
+        valid = (count <= INT_MAX && count <= length / sizeof(uint32_t) && expected == (uint64_t)length);
+    }
+
+    if (valid) {
+        blob = (const char*)(offsets + header->count + 1);
+        valid = (offsets[0] == 0 && offsets[header->count] == header->blobSize);
+        for (uint32_t i = 0; valid && i < header->count; i++) {
+            valid = (offsets[i] < offsets[i+1] && blob[offsets[i+1] - 1] == '\0');
+        }
+    }
+
+    if (!valid) {
+        munmap(base, length);
+        return NULL;
+    }
+
+    OrderingTable* table = new OrderingTable(header->name, offsets, blob, (int)header->count);
+
+    lock_guard<mutex> lock(s_loadedLock);
+    s_loadedTables.push_back(table);
+
+    return table;
+}
+
+int OrderingTables::Save(const OrderingTable* table, const char* path)
+{
+    if (table == NULL)
+        return 0;
+
+    vector<const char*> entries(table->GetSize());
+    for (int i = 0; i < table->GetSize(); i++)
+        entries[i] = table->Get(i);
+
+    return Save(table->GetName(), entries.data(), (int)entries.size(), path);
+}
+
+int OrderingTables::Save(const char* name, const char** entries, int size, const char* path)
+{
+    OrderingFileHeader header;
+    if (name == NULL || strlen(name) >= sizeof(header.name) || size <= 0)
+        return 0;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ORDERING_FILE_MAGIC, 4);
+    header.version = ORDERING_FILE_VERSION;
+    header.count = size;
+    strcpy(header.name, name);
+
+    vector<uint32_t> offsets(size + 1);
+    uint32_t blobSize = 0;
+    for (int i = 0; i < size; i++) {
+        offsets[i] = blobSize;
+        blobSize += strlen(entries[i]) + 1;
+    }
+    offsets[size] = blobSize;
+    header.blobSize = blobSize;
+
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL)
+        return 0;
+
+    bool ok = (fwrite(&header, sizeof(header), 1, fp) == 1 &&
+               fwrite(offsets.data(), sizeof(uint32_t), offsets.size(), fp) == offsets.size());
+    for (int i = 0; ok && i < size; i++)
+        ok = (fwrite(entries[i], strlen(entries[i]) + 1, 1, fp) == 1);
+
+    if (fclose(fp) != 0)
+        ok = false;
+
+    return ok ? 1 : 0;
+}
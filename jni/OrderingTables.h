@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// An ordering table lists the starting hand classes of a game from strongest
+// to weakest (ProPokerTools ranking). Percent ranges such as "15%" or
+// "10-25%" are resolved against one of these tables.
+//
+// Tables are immutable once registered, so any number of distributions and
+// threads can share them, each one choosing the table it needs (6-max Hold'em,
+// full ring PLO, PLO8...) instead of going through a process-wide pointer.
+//
+// A table either wraps a compiled-in array of strings or the string blob of
+// a memory-mapped binary ordering file (see OrderingTables::Load).
+///////////////////////////////////////////////////////////////////////////////
+class OrderingTable
+{
+public:
+	OrderingTable(const char* name, const char** entries, int size);
+	OrderingTable(const char* name, const uint32_t* offsets, const char* blob, int size);
+	~OrderingTable();
+
+	const char* GetName() const { return m_name; }
+	const char* Get(int index) const { return m_entries ? m_entries[index] : m_blob + m_offsets[index]; }
+	const char** GetEntries() const { return m_entries; }
+	int GetSize() const { return m_size; }
+
+	// Position of an entry (exact text match) in the table, or -1.
+	int IndexOf(const char* entry) const;
+
+	// Convert a percent slice such as 10-25% into the half open index
+	// range [first, last) of the entries it covers.
+	void Slice(double lowerPercent, double upperPercent, int& first, int& last) const;
+
+private:
+	void BuildIndex() const;
+
+	const char* m_name;
+	const char** m_entries;
+	const uint32_t* m_offsets;
+	const char* m_blob;
+	int m_size;
+
+	// positions sorted by entry text, built on first use of IndexOf()
+	mutable vector<int> m_sortedIndex;
+	mutable once_flag m_indexOnce;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Registry of the ordering tables known to the library.
+///////////////////////////////////////////////////////////////////////////////
+class OrderingTables
+{
+public:
+	enum Id
+	{
+		Holdem6Max = 0,		// "he6"
+		Holdem10Max,		// "he10"
+		Omaha6Max,			// "oh6"
+		Omaha10Max,			// "oh10"
+		Omaha8_6Max,		// "o86"
+		Omaha8_10Max,		// "o810"
+		BuiltinCount
+	};
+
+	// Tables loaded with Load() take precedence over built-in tables of the
+	// same name, so a shipped file can replace a compiled-in ordering.
+	static const OrderingTable* Get(int id);
+	static const OrderingTable* Find(const char* name);
+
+	// Map a binary ordering file read-only and register the table it holds
+	// under the name stored in the file. The mapping stays alive for the life
+	// of the process. Returns NULL if the file is missing or malformed.
+	static const OrderingTable* Load(const char* path);
+
+	// Write a table (or any array of hand classes) in the binary format read
+	// by Load(). Returns 1 on success, 0 on failure.
+	static int Save(const OrderingTable* table, const char* path);
+	static int Save(const char* name, const char** entries, int size, const char* path);
+
+	// The table used when a distribution does not ask for one. This honours
+	// the legacy HoldemOrdering/OmahaOrdering pointers when they are set to
+	// one of the built-in arrays, and is the 10-max table otherwise.
+	static const OrderingTable* DefaultHoldem();
+	static const OrderingTable* DefaultOmaha();
+
+private:
+	OrderingTables(void) { }
+
+	static const OrderingTable* FindByEntries(const char** entries);
+	static const OrderingTable* FindLoaded(const char* name);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Binary ordering file layout. All integers are in the byte order of the
+// host that wrote the file, as the file is used in place; one written on a
+// host of the other byte order has its version byte-swapped and is refused.
+//
+//		OrderingFileHeader
+//		uint32_t offsets[count + 1]		(entry i is blob[offsets[i]], NUL terminated)
+//		char blob[blobSize]
+//
+// The strings are used in place from the mapping, so loading a table costs no
+// allocations or relocations regardless of its size.
+///////////////////////////////////////////////////////////////////////////////
+#define ORDERING_FILE_MAGIC		"PHOT"
+#define ORDERING_FILE_VERSION	1
+
+struct OrderingFileHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t count;
+	uint32_t blobSize;
+	char name[16];
+};
@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include "HandDistributions.h"
+#include "ParseError.h"
+
+static const char* const MESSAGES[ParseError::CodeCount] =
+{
+    "no error",
+    "unexpected character",
+    "missing cards",
+    "extra characters",
+    "no closing ']'",
+    "no opening '['",
+    "suit inside brackets",
+    "bad gap",
+    "unknown filter",
+    "bad weight",
+    "bad expression",
+    "bad dead cards"
+};
+
+const char* ParseError::GetMessage(Code code)
+{
+    return (unsigned)code < CodeCount ? MESSAGES[code] : "";
+}
+
+int ParseError::Format(char* buffer, size_t size) const
+{
+    if (code == None)
+        return snprintf(buffer, size, "%s", GetMessage(code));
+    if (*expected == '\0')
+        return snprintf(buffer, size, "%s at %d", GetMessage(code), offset);
+    return snprintf(buffer, size, "%s at %d, expected %s", GetMessage(code), offset, expected);
+}
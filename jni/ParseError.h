@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Why a range or agnostic hand failed to parse: what went wrong, where, and
+// what would have been accepted there. The parsers only fill one in; it is
+// up to the caller whether and how to report it:
+//
+//		ParseError error;
+//		if (!HoldemHandDistribution::Validate("QQ+,AKx", &error)) {
+//			char message[128];
+//			error.Format(message, sizeof(message));
+//			...
+//		}
+//
+// Only the first error of a parse is kept.
+///////////////////////////////////////////////////////////////////////////////
+struct ParseError
+{
+	enum Code
+	{
+		None,
+		UnexpectedChar,			// a character that can't appear there
+		MissingCards,			// the text ends before the hand has all its cards
+		ExtraChars,				// text after a complete hand
+		UnclosedBracket,		// "[AK" without its ']'
+		UnopenedBracket,		// ']' without a '['
+		SuitInBrackets,			// "[AhK]xx": brackets already give the suits
+		BadGap,					// ":<gap>" not a number from 0 to 12
+		BadFilter,				// unknown "/<filter>"
+		BadWeight,				// ":<weight>" not a finite number >= 0
+		BadExpression,			// unbalanced parentheses or a missing operand
+		BadDeadCards,			// dead cards that are not card text
+		CodeCount
+	};
+
+	Code code;
+	int offset;				// of the error in the text parsed, -1 if none
+	const char* expected;	// what would have been accepted there, or ""
+
+	ParseError() { Clear(); }
+
+	void Clear() { code = None; offset = -1; expected = ""; }
+	bool IsError() const { return code != None; }
+
+	// Record an error unless one already is
+	void Set(Code errorCode, int errorOffset, const char* errorExpected = "")
+	{
+		if (code == None) {
+			code = errorCode;
+			offset = errorOffset;
+			expected = errorExpected;
+		}
+	}
+
+	// Shift the offset of an error found in a part of a longer text
+	void Shift(int start) { if (code != None) offset += start; }
+
+	static const char* GetMessage(Code code);
+
+	// e.g. "unexpected character at 5, expected one of SsOo+-", truncated to
+	// size; returns the length of the whole message.
+	int Format(char* buffer, size_t size) const;
+};
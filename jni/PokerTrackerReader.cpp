@@ -0,0 +1,261 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <fcntl.h>
+#include <cerrno>
+#include <unistd.h>
+#include <inlines/eval.h>
+#include "HandDistributions.h"
+#include "PokerTrackerReader.h"
+#include "CardConverter.h"
+#include "HandBitset.h"
+
+const size_t PokerTrackerReader::BUFFER_SIZE;
+
+// End of the CSV field starting at p: the next comma outside quotes, or end
+static const char* FieldEnd(const char* p, const char* end)
+{
+    bool quoted = false;
+    for (; p < end; p++) {
+        if (*p == '"')
+            quoted = !quoted;
+        else if (*p == ',' && !quoted)
+            break;
+    }
+    return p;
+}
+
+// A field without its quotes and surrounding blanks
+static void Trim(const char*& p, const char*& end)
+{
+    while (p < end && (*p == ' ' || *p == '"'))
+        p++;
+    while (end > p && (end[-1] == ' ' || end[-1] == '"' || end[-1] == '\r'))
+        end--;
+}
+
+PokerTrackerReader::PokerTrackerReader()
+    : m_fd(-1), m_begin(0), m_end(0), m_eof(true), m_rows(0), m_invalid(0)
+{
+}
+
+PokerTrackerReader::~PokerTrackerReader()
+{
+    Close();
+}
+
+void PokerTrackerReader::Close()
+{
+    if (m_fd >= 0)
+        close(m_fd);
+    m_fd = -1;
+    m_begin = m_end = 0;
+    m_eof = true;
+}
+
+bool PokerTrackerReader::Open(const char* path, const char* columns)
+{
+    Close();
+    m_columns.clear();
+    m_slots.clear();
+    m_rows = m_invalid = 0;
+
+    m_fd = open(path, O_RDONLY);
+    if (m_fd < 0)
+        return false;
+    m_buffer.resize(BUFFER_SIZE);
+    m_eof = false;
+
+    const char* header = NextLine();
+    if (header == NULL) {
+        Close();
+        return false;
+    }
+    const char* headerEnd = m_buffer.data() + m_begin - 1;
+
+    // Find each wanted column among the header's fields
+    for (const char* name = columns; *name != '\0'; ) {
+        const char* nameEnd = name + strcspn(name, ",");
+        const char* trimmed = name;
+        Trim(trimmed, nameEnd);
+
+        int column = -1, field = 0;
+        for (const char* p = header; p <= headerEnd; field++) {
+            const char* end = FieldEnd(p, headerEnd);
+            const char* q = p;
+            Trim(q, end);
+            if (end - q == nameEnd - trimmed && memcmp(q, trimmed, end - q) == 0) {
+                column = field;
+                break;
+            }
+            p = FieldEnd(p, headerEnd) + 1;
+        }
+        if (column < 0 || (int)m_columns.size() == MAX_CARDS) {
+            Close();
+            return false;
+        }
+        m_columns.push_back(column);
+
+        name += strcspn(name, ",");
+        if (*name == ',')
+            name++;
+    }
+    if (m_columns.empty()) {
+        Close();
+        return false;
+    }
+
+    m_slots.assign(*max_element(m_columns.begin(), m_columns.end()) + 1, -1);
+    for (size_t i = 0; i < m_columns.size(); i++)
+        m_slots[m_columns[i]] = (int8_t)i;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Move what is left to the front of the buffer and read up to the rest of it.
+///////////////////////////////////////////////////////////////////////////////
+bool PokerTrackerReader::Fill()
+{
+    if (m_eof)
+        return false;
+
+    memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+    m_end -= m_begin;
+    m_begin = 0;
+
+    ssize_t bytes;
+    do {
+        bytes = read(m_fd, m_buffer.data() + m_end, m_buffer.size() - m_end);
+    } while (bytes < 0 && errno == EINTR);
+    if (bytes <= 0) {
+        m_eof = true;
+        return false;
+    }
+    m_end += bytes;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Start of the next whole line, which then ends just before m_begin, or NULL
+// at the end of the file. The last line need not end with a newline; a line
+// too long for the buffer is skipped and counted as an invalid row.
+///////////////////////////////////////////////////////////////////////////////
+const char* PokerTrackerReader::NextLine()
+{
+    for (;;) {
+        char* text = m_buffer.data();
+        char* newline = (char*)memchr(text + m_begin, '\n', m_end - m_begin);
+        if (newline != NULL) {
+            const char* line = text + m_begin;
+            m_begin = newline - text + 1;
+            return line;
+        }
+
+        if (m_begin == 0 && m_end == m_buffer.size()) {
+            // No newline in a full buffer: drop it and the rest of the line
+            m_begin = m_end;
+            m_invalid++;
+            while (Fill()) {
+                newline = (char*)memchr(m_buffer.data(), '\n', m_end);
+                if (newline != NULL) {
+                    m_begin = newline - m_buffer.data() + 1;
+                    break;
+                }
+                m_begin = m_end;
+            }
+            continue;
+        }
+
+        if (!Fill()) {
+            if (m_begin == m_end)
+                return NULL;
+            // Last line, without a newline: terminate it past the text
+            if (m_end == m_buffer.size())
+                m_buffer.push_back('\n');
+            else
+                m_buffer[m_end] = '\n';
+            const char* line = m_buffer.data() + m_begin;
+            m_begin = ++m_end;
+            return line;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The card ids of one line; a missing or non-numeric field is 0 (unknown).
+///////////////////////////////////////////////////////////////////////////////
+void PokerTrackerReader::ParseRow(const char* line, const char* end, int* ids) const
+{
+    for (size_t i = 0; i < m_columns.size(); i++)
+        ids[i] = 0;
+
+    int fields = (int)m_slots.size();
+    const char* p = line;
+    for (int field = 0; field < fields && p <= end; field++) {
+        const char* fieldEnd = FieldEnd(p, end);
+        int slot = m_slots[field];
+        if (slot >= 0) {
+            const char* q = p;
+            const char* e = fieldEnd;
+            Trim(q, e);
+            int id = 0;
+            for (; q < e && (unsigned)(*q - '0') < 10 && id < 1000; q++)
+                id = id * 10 + (*q - '0');
+            ids[slot] = (q == e) ? id : 0;
+        }
+        p = fieldEnd + 1;
+    }
+}
+
+size_t PokerTrackerReader::Read(uint64_t* hands, int* indices, size_t capacity)
+{
+    int cards = GetCardsPerRow();
+    if (m_fd < 0 || cards == 0)
+        return 0;
+
+    if (m_ids.size() < capacity * cards)
+        m_ids.resize(capacity * cards);
+
+    size_t rows = 0;
+    while (rows < capacity) {
+        const char* line = NextLine();
+        if (line == NULL)
+            break;
+        const char* end = m_buffer.data() + m_begin - 1;
+        if (end > line && end[-1] == '\r')
+            end--;
+        if (end == line)
+            continue;		// blank line
+        ParseRow(line, end, &m_ids[rows * cards]);
+        rows++;
+    }
+
+    size_t converted = CardConverter::PokerTrackerToBits(m_ids.data(), cards, rows, hands);
+    m_rows += rows;
+    m_invalid += rows - converted;
+
+    if (indices != NULL) {
+        // Only hands of up to four cards are indexed
+        for (size_t i = 0; i < rows; i++)
+            indices[i] = cards <= 4 ? HandBitset::IndexOfBits(hands[i], cards) : -1;
+    }
+    return rows;
+}
@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Streaming reader for CSV dumps of a PokerTracker database (e.g. COPY ...
+// TO ... WITH CSV HEADER), turning the card id columns of each row into a
+// packed hand. Rows are read in batches through a fixed buffer, so a dump of
+// any size is read in constant memory:
+//
+//		PokerTrackerReader reader;
+//		reader.Open("holdem_hand_player_statistics.csv", "holecard_1,holecard_2");
+//		while ((rows = reader.Read(hands, indices, 4096)) > 0)
+//			...
+//
+// The ids are converted with CardConverter::PokerTrackerToBits() and, for
+// two and four card hands, indexed with HandBitset::IndexOfBits().
+///////////////////////////////////////////////////////////////////////////////
+class PokerTrackerReader
+{
+public:
+	static const int MAX_CARDS = 7;
+	static const size_t BUFFER_SIZE = 1 << 20;	// also the longest line
+
+	PokerTrackerReader();
+	~PokerTrackerReader();
+
+	// Open a file whose first line names its columns, to read the cards of
+	// each row from the columns listed in columns, separated by commas.
+	// Returns false if the file can't be read or lacks one of the columns.
+	bool Open(const char* path, const char* columns);
+	void Close();
+
+	int GetCardsPerRow() const { return (int)m_columns.size(); }
+
+	// Read the next capacity rows or fewer. hands[i] gets the cards of a row
+	// (0 if one is unknown or invalid) and, unless indices is NULL,
+	// indices[i] gets their HandBitset index (-1 if there is none, and for
+	// more than four cards). Returns the number of rows read; 0 at the end
+	// of the file.
+	size_t Read(uint64_t* hands, int* indices, size_t capacity);
+
+	int64_t GetRows() const { return m_rows; }
+	int64_t GetInvalid() const { return m_invalid; }
+
+private:
+	bool Fill();
+	const char* NextLine();
+	void ParseRow(const char* line, const char* end, int* ids) const;
+
+	int m_fd;
+	vector<char> m_buffer;
+	size_t m_begin;				// unread text is m_buffer[m_begin, m_end)
+	size_t m_end;
+	bool m_eof;
+
+	vector<int> m_columns;		// field number of each card, in card order
+	vector<int8_t> m_slots;		// card of each field up to the last card, or -1
+	vector<int> m_ids;			// ids of the rows of a batch
+
+	int64_t m_rows;
+	int64_t m_invalid;
+};
@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <inlines/eval.h>
+#include "HandDistributions.h"
+#include "PreflopTable.h"
+#include "HandBitset.h"
+
+PreflopTable::PreflopTable(const float* classes, const uint16_t* combos)
+    : m_classes(classes), m_combos(combos)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Tables are never unloaded, so the pointer handed out by Get() stays valid
+// for the life of the process.
+///////////////////////////////////////////////////////////////////////////////
+static mutex s_tableLock;
+static const PreflopTable* s_table = NULL;
+
+const PreflopTable* PreflopTable::Get(void)
+{
+    lock_guard<mutex> lock(s_tableLock);
+    return s_table;
+}
+
+int PreflopTable::ClassOf(StdDeck_CardMask hand)
+{
+    int ranks[2], suits[2], n = 0;
+    for (int card = 0; card < StdDeck_N_CARDS && n < 2; card++) {
+        if (StdDeck_CardMask_CARD_IS_SET(hand, card)) {
+            ranks[n] = StdDeck_RANK(card);
+            suits[n] = StdDeck_SUIT(card);
+            n++;
+        }
+    }
+    if (n != 2)
+        return -1;
+
+    int hi = max(ranks[0], ranks[1]);
+    int lo = min(ranks[0], ranks[1]);
+    return suits[0] == suits[1] ? hi * 13 + lo : lo * 13 + hi;
+}
+
+double PreflopTable::Equity(StdDeck_CardMask hand0, StdDeck_CardMask hand1) const
+{
+    if (m_combos != NULL)
+        return m_combos[HandBitset::Index(hand0, 2) * ComboCount + HandBitset::Index(hand1, 2)] / 65535.0;
+
+    return ClassEquity(ClassOf(hand0), ClassOf(hand1));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Map a preflop equity file and make it current. The size must match the
+// header exactly and every class equity must lie in [0, 1].
+///////////////////////////////////////////////////////////////////////////////
+const PreflopTable* PreflopTable::Load(const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(PreflopFileHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t length = (size_t)st.st_size;
+    void* base = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file referenced
+    if (base == MAP_FAILED)
+        return NULL;
+
+    const PreflopFileHeader* header = (const PreflopFileHeader*)base;
+    const float* classes = (const float*)(header + 1);
+    const uint16_t* combos = NULL;
+
+    // The version also tells a file of the other byte order, in which it
+    // reads byte-swapped
+    bool valid = (memcmp(header->magic, PREFLOP_FILE_MAGIC, 4) == 0 &&
+                  header->version == PREFLOP_FILE_VERSION &&
+                  header->classes == ClassCount &&
+                  (header->combos == 0 || header->combos == ComboCount));
+
+    if (valid) {
+        size_t expected = sizeof(PreflopFileHeader) + ClassCount * ClassCount * sizeof(float) +
+                          header->combos * header->combos * sizeof(uint16_t);
+        valid = (expected == length);
+    }
+
+    for (int i = 0; valid && i < ClassCount * ClassCount; i++)
+        valid = (classes[i] >= 0.0f && classes[i] <= 1.0f);
+
+    if (!valid) {
+        munmap(base, length);
+        return NULL;
+    }
+
+    if (header->combos)
+        combos = (const uint16_t*)(classes + ClassCount * ClassCount);
+
+    PreflopTable* table = new PreflopTable(classes, combos);
+
+    lock_guard<mutex> lock(s_tableLock);
+    s_table = table;
+
+    return table;
+}
+
+int PreflopTable::Save(const char* path, const float* classEquity, const uint16_t* comboEquity)
+{
+    if (classEquity == NULL)
+        return 0;
+
+    PreflopFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PREFLOP_FILE_MAGIC, 4);
+    header.version = PREFLOP_FILE_VERSION;
+    header.classes = ClassCount;
+    header.combos = comboEquity ? ComboCount : 0;
+
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL)
+        return 0;
+
+    bool ok = (fwrite(&header, sizeof(header), 1, fp) == 1 &&
+               fwrite(classEquity, sizeof(float), ClassCount * ClassCount, fp) == ClassCount * ClassCount);
+    if (ok && comboEquity != NULL)
+        ok = (fwrite(comboEquity, sizeof(uint16_t), ComboCount * ComboCount, fp) == ComboCount * ComboCount);
+
+    if (fclose(fp) != 0)
+        ok = false;
+
+    return ok ? 1 : 0;
+}
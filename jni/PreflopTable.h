@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Heads-up preflop Hold'em equities, precomputed by tools/preflopgen.cpp and
+// memory-mapped from a file at startup:
+//
+//		- the 169x169 table of starting hand class against class, each entry
+//		  averaged over the combinations of the two classes that don't share
+//		  a card (so card removal is already accounted for);
+//		- optionally the 1326x1326 table of hand against hand (3.5MB), which
+//		  makes range against range lookups exact.
+//
+// Classes are numbered on the usual 13x13 grid: for ranks hi >= lo (Two = 0
+// .. Ace = 12), pairs are hi*13+hi, suited hands hi*13+lo and offsuit hands
+// lo*13+hi. Hands are numbered as in HandBitset.
+///////////////////////////////////////////////////////////////////////////////
+class PreflopTable
+{
+public:
+	enum
+	{
+		ClassCount = 169,
+		ComboCount = 1326
+	};
+
+	// The most recently loaded table, or NULL if none has been loaded.
+	static const PreflopTable* Get();
+
+	// Map a preflop equity file read-only and make it the current table. The
+	// mapping stays alive for the life of the process. Returns NULL if the
+	// file is missing or malformed.
+	static const PreflopTable* Load(const char* path);
+
+	// Write a table in the format read by Load(). comboEquity may be NULL to
+	// leave the hand against hand table out. Returns 1 on success, 0 on
+	// failure.
+	static int Save(const char* path, const float* classEquity, const uint16_t* comboEquity);
+
+	static int ClassOf(StdDeck_CardMask hand);
+
+	bool HasCombos() const { return m_combos != NULL; }
+	double ClassEquity(int class0, int class1) const { return m_classes[class0 * ClassCount + class1]; }
+
+	// Equity of hand0 against hand1, exact if the file has the hand against
+	// hand table and the class average otherwise. The hands must not share
+	// a card.
+	double Equity(StdDeck_CardMask hand0, StdDeck_CardMask hand1) const;
+
+private:
+	PreflopTable(const float* classes, const uint16_t* combos);
+
+	const float* m_classes;
+	const uint16_t* m_combos;	// equity * 65535
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Preflop equity file layout. All numbers are in the byte order of the host
+// that wrote the file, as the tables are used in place; a file from a host
+// of the other byte order has its version byte-swapped and is refused.
+//
+//		PreflopFileHeader
+//		float classEquity[169 * 169]
+//		uint16_t comboEquity[1326 * 1326]		(if combos == 1326)
+///////////////////////////////////////////////////////////////////////////////
+#define PREFLOP_FILE_MAGIC		"PHPF"
+#define PREFLOP_FILE_VERSION	1
+
+struct PreflopFileHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t classes;
+	uint32_t combos;
+};
@@ -0,0 +1,282 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "HandDistributions.h"
+#include "RandomEngine.h"
+#include <chrono>
+
+RandomEngine::RandomEngine(void)
+    : m_next(0), m_end(0), m_half(0), m_hasHalf(false), m_seed(0)
+{
+}
+
+RandomEngine::~RandomEngine(void)
+{
+}
+
+RandomEngine* RandomEngine::Create(int type, uint64_t seed)
+{
+    switch (type) {
+    case Philox:
+        return new PhiloxEngine(seed);
+    case Xoshiro256:
+        return new Xoshiro256Engine(seed);
+    case Pcg64:
+        return new Pcg64Engine(seed);
+    case Mersenne:
+        return new MersenneEngine(seed);
+    }
+    return NULL;
+}
+
+uint64_t RandomEngine::SplitMix(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The clock, a process-wide count of the seeds handed out and (once) the
+// system's entropy source, mixed with SplitMix64. Never 0, which callers use
+// to mean "pick a seed".
+///////////////////////////////////////////////////////////////////////////////
+uint64_t RandomEngine::NewSeed(void)
+{
+    static atomic<uint64_t> s_count(0);
+    static const uint64_t s_entropy = ((uint64_t)std::random_device()() << 32) ^ std::random_device()();
+
+    uint64_t state = s_entropy + (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count()
+        + 0x9E3779B97F4A7C15ULL * ++s_count;
+    uint64_t seed = SplitMix(state);
+    return seed ? seed : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Engines without streams of their own restart from the seed hashed with the
+// stream number.
+///////////////////////////////////////////////////////////////////////////////
+void RandomEngine::Jump(uint64_t stream)
+{
+    uint64_t state = m_seed ^ (stream * 0xD1B54A32D192ED03ULL);
+    Restart(SplitMix(state));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Lemire's method on both 32 bit halves of each raw number. The first pass
+// has no branches; the rare results that may be biased (low half of the
+// product under 2^32 mod bound) are redrawn afterwards.
+///////////////////////////////////////////////////////////////////////////////
+void RandomEngine::FillBelow(uint32_t bound, uint32_t* out, size_t count)
+{
+    uint32_t threshold = (uint32_t)(-bound) % bound;
+    uint64_t raw[BUFFER_SIZE * 4];
+    uint32_t halves[BUFFER_SIZE * 8];
+
+    size_t done = 0;
+    while (done < count) {
+        size_t n = min(count - done, (size_t)BUFFER_SIZE * 8);
+        Generate(raw, (n + 1) / 2);
+        for (size_t i = 0; i < (n + 1) / 2; i++) {
+            halves[2 * i] = (uint32_t)raw[i];
+            halves[2 * i + 1] = (uint32_t)(raw[i] >> 32);
+        }
+
+        uint32_t* dest = out + done;
+        uint32_t biased = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t m = (uint64_t)halves[i] * bound;
+            dest[i] = (uint32_t)(m >> 32);
+            biased |= ((uint32_t)m < threshold);
+        }
+
+        if (biased) {
+            for (size_t i = 0; i < n; i++) {
+                uint64_t m = (uint64_t)halves[i] * bound;
+                if ((uint32_t)m < threshold)
+                    dest[i] = Below(bound);
+            }
+        }
+        done += n;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Philox4x32-10
+///////////////////////////////////////////////////////////////////////////////
+void PhiloxEngine::Restart(uint64_t seed)
+{
+    m_key[0] = (uint32_t)seed;
+    m_key[1] = (uint32_t)(seed >> 32);
+    Jump(0);
+}
+
+void PhiloxEngine::Jump(uint64_t stream)
+{
+    m_counter[0] = 0;
+    m_counter[1] = 0;
+    m_counter[2] = (uint32_t)stream;
+    m_counter[3] = (uint32_t)(stream >> 32);
+}
+
+void PhiloxEngine::Generate(uint64_t* out, size_t count)
+{
+    for (size_t i = 0; i < count; i += 2) {
+        uint32_t c0 = m_counter[0], c1 = m_counter[1], c2 = m_counter[2], c3 = m_counter[3];
+        uint32_t k0 = m_key[0], k1 = m_key[1];
+        for (int round = 0; round < 10; round++) {
+            uint64_t p0 = (uint64_t)0xD2511F53 * c0;
+            uint64_t p1 = (uint64_t)0xCD9E8D57 * c2;
+            c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+            c1 = (uint32_t)p1;
+            c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+            c3 = (uint32_t)p0;
+            k0 += 0x9E3779B9;
+            k1 += 0xBB67AE85;
+        }
+
+        // Next block of this stream
+        if (++m_counter[0] == 0)
+            m_counter[1]++;
+
+        out[i] = ((uint64_t)c0 << 32) | c1;
+        if (i + 1 < count)
+            out[i + 1] = ((uint64_t)c2 << 32) | c3;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// xoshiro256**
+///////////////////////////////////////////////////////////////////////////////
+void Xoshiro256Engine::SetState(const uint64_t state[4])
+{
+    for (int i = 0; i < 4; i++)
+        m_state[i] = state[i];
+    Discard();
+}
+
+void Xoshiro256Engine::Restart(uint64_t seed)
+{
+    for (int i = 0; i < 4; i++)
+        m_state[i] = SplitMix(seed);
+}
+
+static inline uint64_t RotateLeft(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+void Xoshiro256Engine::Generate(uint64_t* out, size_t count)
+{
+    uint64_t s0 = m_state[0], s1 = m_state[1], s2 = m_state[2], s3 = m_state[3];
+    for (size_t i = 0; i < count; i++) {
+        out[i] = RotateLeft(s1 * 5, 7) * 9;
+        uint64_t t = s1 << 17;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = RotateLeft(s3, 45);
+    }
+    m_state[0] = s0;
+    m_state[1] = s1;
+    m_state[2] = s2;
+    m_state[3] = s3;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PCG XSL RR 128/64
+///////////////////////////////////////////////////////////////////////////////
+static const uint64_t PCG_MULTIPLIER_HIGH = 2549297995355413924ULL;
+static const uint64_t PCG_MULTIPLIER_LOW = 4865540595714422341ULL;
+
+// High 64 bits of the 128 bit product of a and b
+static inline uint64_t MultiplyHigh(uint64_t a, uint64_t b)
+{
+    uint64_t aLow = (uint32_t)a, aHigh = a >> 32;
+    uint64_t bLow = (uint32_t)b, bHigh = b >> 32;
+    uint64_t low = aLow * bLow;
+    uint64_t middle1 = aHigh * bLow + (low >> 32);
+    uint64_t middle2 = aLow * bHigh + (uint32_t)middle1;
+    return aHigh * bHigh + (middle1 >> 32) + (middle2 >> 32);
+}
+
+void Pcg64Engine::Step()
+{
+    // state = state * multiplier + increment, mod 2^128
+    uint64_t high = MultiplyHigh(m_state[1], PCG_MULTIPLIER_LOW)
+        + m_state[1] * PCG_MULTIPLIER_HIGH + m_state[0] * PCG_MULTIPLIER_LOW;
+    uint64_t low = m_state[1] * PCG_MULTIPLIER_LOW;
+
+    m_state[1] = low + m_increment[1];
+    m_state[0] = high + m_increment[0] + (m_state[1] < low);
+}
+
+void Pcg64Engine::SetState(uint64_t stateHigh, uint64_t stateLow, uint64_t sequenceHigh, uint64_t sequenceLow)
+{
+    m_state[0] = 0;
+    m_state[1] = 0;
+    m_increment[0] = (sequenceHigh << 1) | (sequenceLow >> 63);
+    m_increment[1] = (sequenceLow << 1) | 1;
+    Step();
+
+    uint64_t low = m_state[1] + stateLow;
+    m_state[0] += stateHigh + (low < stateLow);
+    m_state[1] = low;
+    Step();
+    Discard();
+}
+
+void Pcg64Engine::Restart(uint64_t seed)
+{
+    uint64_t state[4];
+    for (int i = 0; i < 4; i++)
+        state[i] = SplitMix(seed);
+    SetState(state[0], state[1], state[2], state[3]);
+}
+
+void Pcg64Engine::Generate(uint64_t* out, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        Step();
+        uint64_t value = m_state[0] ^ m_state[1];
+        int rotation = (int)(m_state[0] >> 58);
+        out[i] = (value >> rotation) | (value << ((64 - rotation) & 63));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MT19937
+///////////////////////////////////////////////////////////////////////////////
+void MersenneEngine::Restart(uint64_t seed)
+{
+    m_mt.seed((uint32_t)seed);
+}
+
+void MersenneEngine::Generate(uint64_t* out, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        uint64_t high = m_mt();
+        out[i] = (high << 32) | m_mt();
+    }
+}
@@ -0,0 +1,233 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+///////////////////////////////////////////////////////////////////////////////
+// Random number engine interface used for dealing: Choose()/Sample() on the
+// distributions, HandCompatibility::Choose(), AliasTable::Sample() and the
+// board. Engines generate 64 bit numbers in bulk (Generate) into a small
+// buffer, so the virtual call is made once per BUFFER_SIZE draws and the
+// draws themselves are inline.
+//
+// Bounded integers use Lemire's multiply-shift ("Fast random integer
+// generation in an interval", 2019): one 32x32 bit multiply, and a division
+// only in the rare case the result might be biased. FillBelow() produces
+// many of them at once from both halves of each 64 bit number, in a loop
+// simple enough for the compiler to vectorize.
+//
+//		Philox			counter-based, Seek() jumps to any stream (default)
+//		Xoshiro256		xoshiro256** (Blackman & Vigna)
+//		Pcg64			PCG XSL RR 128/64 (O'Neill)
+//		Mersenne		MT19937, the sequence MTRand53 draws from
+//
+// Seek(stream) moves to the start of stream number stream of the current
+// seed. Philox jumps there; the others restart from the seed hashed with the
+// stream, which for Mersenne means seeding its 624 words of state again on
+// every trial (it is there to compare against MTRand, not for speed).
+///////////////////////////////////////////////////////////////////////////////
+class RandomEngine
+{
+public:
+	enum Type
+	{
+		Philox,
+		Xoshiro256,
+		Pcg64,
+		Mersenne,
+		TypeCount
+	};
+
+	virtual ~RandomEngine(void);
+
+	// New engine of the given type, or NULL for an unknown type.
+	static RandomEngine* Create(int type, uint64_t seed);
+
+	// A seed that differs between calls and between processes, for runs that
+	// weren't given one.
+	static uint64_t NewSeed();
+
+	void SetSeed(uint64_t seed) { m_seed = seed; Restart(seed); Discard(); }
+	uint64_t GetSeed() const { return m_seed; }
+	void Seek(uint64_t stream) { Jump(stream); Discard(); }
+
+	uint64_t Next64()
+	{
+		if (m_next == m_end)
+			Refill();
+		return m_buffer[m_next++];
+	}
+
+	// Both halves of a 64 bit number are used
+	uint32_t Next32()
+	{
+		if (m_hasHalf) {
+			m_hasHalf = false;
+			return m_half;
+		}
+		uint64_t x = Next64();
+		m_half = (uint32_t)x;
+		m_hasHalf = true;
+		return (uint32_t)(x >> 32);
+	}
+
+	// Uniform on [0, 1) with 53 bits
+	double operator()() { return (Next64() >> 11) * (1.0 / 9007199254740992.0); }
+
+	// Uniform integer in [0, bound), bound > 0
+	uint32_t Below(uint32_t bound)
+	{
+		uint64_t m = (uint64_t)Next32() * bound;
+		if ((uint32_t)m < bound) {
+			uint32_t threshold = (uint32_t)(-bound) % bound;
+			while ((uint32_t)m < threshold)
+				m = (uint64_t)Next32() * bound;
+		}
+		return (uint32_t)(m >> 32);
+	}
+
+	// MTRand53 compatible spelling of Below()
+	long under(int bound) { return Below(bound); }
+
+	// count uniform integers in [0, bound) into out.
+	void FillBelow(uint32_t bound, uint32_t* out, size_t count);
+
+	// count raw 64 bit numbers into out, bypassing the buffer.
+	void Fill(uint64_t* out, size_t count) { Generate(out, count); }
+
+protected:
+	RandomEngine();
+
+	virtual void Restart(uint64_t seed) = 0;
+	virtual void Jump(uint64_t stream);
+	virtual void Generate(uint64_t* out, size_t count) = 0;
+
+	// Drop the buffered numbers after the state has changed.
+	void Discard() { m_next = m_end = 0; m_hasHalf = false; }
+
+	// SplitMix64 (Steele et al.), to expand a seed into engine state
+	static uint64_t SplitMix(uint64_t& state);
+
+private:
+	enum { BUFFER_SIZE = 16 };
+
+	void Refill() { Generate(m_buffer, BUFFER_SIZE); m_next = 0; m_end = BUFFER_SIZE; }
+
+	uint64_t m_buffer[BUFFER_SIZE];
+	int m_next;
+	int m_end;
+	uint32_t m_half;		// low half of the last number, not yet used
+	bool m_hasHalf;
+	uint64_t m_seed;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random
+// numbers: as easy as 1, 2, 3"). Every block of four 32 bit numbers is a
+// keyed hash of a 128 bit counter, so any point of any stream can be reached
+// at once instead of by stepping a state forward:
+//
+//		key     = the 64 bit seed
+//		counter = the 64 bit stream (a trial number) : 64 bit block number
+//
+// The calculators seek to stream i at the start of trial i, which makes
+// trial i of a run with seed s deal the same cards whichever thread runs it
+// and whatever ran before it. Streams are independent for practical
+// purposes.
+///////////////////////////////////////////////////////////////////////////////
+class PhiloxEngine : public RandomEngine
+{
+public:
+	PhiloxEngine(uint64_t seed = 0, uint64_t stream = 0) { SetSeed(seed); Seek(stream); }
+
+protected:
+	virtual void Restart(uint64_t seed);
+	virtual void Jump(uint64_t stream);
+	virtual void Generate(uint64_t* out, size_t count);
+
+private:
+	uint32_t m_key[2];
+	uint32_t m_counter[4];
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// xoshiro256**: 256 bits of state, period 2^256 - 1.
+///////////////////////////////////////////////////////////////////////////////
+class Xoshiro256Engine : public RandomEngine
+{
+public:
+	Xoshiro256Engine(uint64_t seed = 0) { SetSeed(seed); }
+
+	// Set the state directly (not all zero).
+	void SetState(const uint64_t state[4]);
+
+protected:
+	virtual void Restart(uint64_t seed);
+	virtual void Generate(uint64_t* out, size_t count);
+
+private:
+	uint64_t m_state[4];
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// PCG XSL RR 128/64: 128 bit LCG state and increment, 64 bit output. The
+// 128 bit arithmetic is done on 64 bit halves, so it also builds for 32 bit
+// ABIs without __int128.
+///////////////////////////////////////////////////////////////////////////////
+class Pcg64Engine : public RandomEngine
+{
+public:
+	Pcg64Engine(uint64_t seed = 0) { SetSeed(seed); }
+
+	// pcg64_srandom_r() of the reference implementation.
+	void SetState(uint64_t stateHigh, uint64_t stateLow, uint64_t sequenceHigh, uint64_t sequenceLow);
+
+protected:
+	virtual void Restart(uint64_t seed);
+	virtual void Generate(uint64_t* out, size_t count);
+
+private:
+	void Step();
+
+	uint64_t m_state[2];		// high, low
+	uint64_t m_increment[2];
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MT19937, seeded like MTRand_int32 so that seed 5489 gives MTRand's
+// sequence up to the first Seek(). Two 32 bit outputs make each 64 bit
+// number.
+///////////////////////////////////////////////////////////////////////////////
+class MersenneEngine : public RandomEngine
+{
+public:
+	MersenneEngine(uint64_t seed = 5489) { SetSeed(seed); }
+
+protected:
+	virtual void Restart(uint64_t seed);
+	virtual void Generate(uint64_t* out, size_t count);
+
+private:
+	std::mt19937 m_mt;
+};
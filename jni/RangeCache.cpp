@@ -0,0 +1,383 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <cerrno>
+#include <cstdio>
+#include <cfloat>
+#include <inlines/eval_omaha.h>
+#include "HandDistributions.h"
+#include "RangeCache.h"
+#include "HoldemHandDistribution.h"
+#include "OmahaHandDistribution.h"
+#include "OrderingTables.h"
+#include "CardConverter.h"
+#include "HandBitset.h"
+#include "HandDistMetrics.h"
+
+#define RANGE_CACHE_SUFFIX	".phrc"
+
+// The directory and the keys of its entries. Set at startup in practice, but
+// Init() may run on any thread, so every access goes through the lock.
+static mutex s_cacheLock;
+static string s_directory;
+static vector<uint64_t> s_keys;		// sorted
+static atomic<bool> s_enabled(false);
+static atomic<int> s_minimumHands(2000);
+static atomic<unsigned> s_tempCount(0);
+
+static bool HasKey(uint64_t key)
+{
+    return binary_search(s_keys.begin(), s_keys.end(), key);
+}
+
+static void AddKey(uint64_t key)
+{
+    vector<uint64_t>::iterator it = lower_bound(s_keys.begin(), s_keys.end(), key);
+    if (it == s_keys.end() || *it != key)
+        s_keys.insert(it, key);
+}
+
+static void RemoveKey(uint64_t key)
+{
+    vector<uint64_t>::iterator it = lower_bound(s_keys.begin(), s_keys.end(), key);
+    if (it != s_keys.end() && *it == key)
+        s_keys.erase(it);
+}
+
+// FNV-1a, continued from hash
+static uint64_t Hash(uint64_t hash, const void* data, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Create the directory if need be and list the keys of the entries in it.
+// Temporary files left by a process that died while writing are ignored.
+///////////////////////////////////////////////////////////////////////////////
+int RangeCache::SetDirectory(const char* path)
+{
+    lock_guard<mutex> lock(s_cacheLock);
+    s_enabled = false;
+    s_directory.clear();
+    s_keys.clear();
+
+    if (path == NULL || *path == '\0')
+        return 1;
+
+    if (mkdir(path, 0755) != 0 && errno != EEXIST)
+        return 0;
+
+    DIR* dir = opendir(path);
+    if (dir == NULL)
+        return 0;
+
+    size_t nameLength = 16 + strlen(RANGE_CACHE_SUFFIX);
+    for (struct dirent* entry = readdir(dir); entry != NULL; entry = readdir(dir)) {
+        const char* name = entry->d_name;
+        if (strlen(name) != nameLength || strcmp(name + 16, RANGE_CACHE_SUFFIX) != 0)
+            continue;
+        char* end;
+        unsigned long long key = strtoull(name, &end, 16);
+        if (end == name + 16)
+            s_keys.push_back(key);
+    }
+    closedir(dir);
+
+    sort(s_keys.begin(), s_keys.end());
+    s_directory = path;
+    s_enabled = true;
+    return 1;
+}
+
+bool RangeCache::IsEnabled()
+{
+    return s_enabled;
+}
+
+void RangeCache::SetMinimumHands(int count)
+{
+    s_minimumHands = max(count, 1);
+}
+
+int RangeCache::GetMinimumHands()
+{
+    return s_minimumHands;
+}
+
+int RangeCache::GetCount()
+{
+    lock_guard<mutex> lock(s_cacheLock);
+    return (int)s_keys.size();
+}
+
+bool RangeCache::Load(const char* text, StdDeck_CardMask dead, HoldemHandDistribution& distribution)
+{
+    const OrderingTable* ordering = distribution.GetOrdering();
+    return LoadDistribution(text, dead, 2, ordering ? ordering : OrderingTables::DefaultHoldem(), distribution);
+}
+
+bool RangeCache::Load(const char* text, StdDeck_CardMask dead, OmahaHandDistribution& distribution)
+{
+    const OrderingTable* ordering = distribution.GetOrdering();
+    return LoadDistribution(text, dead, OMAHA_MAXHOLE, ordering ? ordering : OrderingTables::DefaultOmaha(), distribution);
+}
+
+int RangeCache::Store(const char* text, StdDeck_CardMask dead, const HoldemHandDistribution& distribution)
+{
+    const OrderingTable* ordering = distribution.GetOrdering();
+    return StoreDistribution(text, dead, 2, ordering ? ordering : OrderingTables::DefaultHoldem(), distribution);
+}
+
+int RangeCache::Store(const char* text, StdDeck_CardMask dead, const OmahaHandDistribution& distribution)
+{
+    const OrderingTable* ordering = distribution.GetOrdering();
+    return StoreDistribution(text, dead, OMAHA_MAXHOLE, ordering ? ordering : OrderingTables::DefaultOmaha(), distribution);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The terms of a range, without the empty ones Init() skips ("AA,,KK,").
+///////////////////////////////////////////////////////////////////////////////
+string RangeCache::Normalize(const char* text)
+{
+    string copy(text);
+    string normal;
+    char* pText = &copy[0];
+    for (char* pTerm = HandBitset::NextTerm(pText); pTerm != NULL; pTerm = HandBitset::NextTerm(pText)) {
+        if (!normal.empty())
+            normal += ',';
+        normal += pTerm;
+    }
+    return normal;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The format version is part of the key, so entries written by another
+// version of the library are never looked at; the ordering's size guards
+// against a loaded table that replaces a built-in one of the same name.
+///////////////////////////////////////////////////////////////////////////////
+uint64_t RangeCache::GetKey(int holeCards, const string& text, uint64_t dead, const OrderingTable* ordering)
+{
+    uint32_t version = RANGE_CACHE_VERSION;
+    uint32_t cards = holeCards;
+    uint32_t size = ordering ? ordering->GetSize() : 0;
+    const char* name = ordering ? ordering->GetName() : "";
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hash = Hash(hash, &version, sizeof(version));
+    hash = Hash(hash, &cards, sizeof(cards));
+    hash = Hash(hash, &dead, sizeof(dead));
+    hash = Hash(hash, name, strlen(name) + 1);
+    hash = Hash(hash, &size, sizeof(size));
+    return Hash(hash, text.data(), text.size());
+}
+
+string RangeCache::GetPath(const string& directory, uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx" RANGE_CACHE_SUFFIX, (unsigned long long)key);
+    return directory + name;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Map the entry and copy the hands out of it. Everything is checked before
+// the distribution is touched: the header against what was asked for, and
+// every hand (right number of cards, none dead, in Init() order). An entry
+// holding another range under the same key is a miss; a damaged one is
+// deleted so that it gets written again.
+///////////////////////////////////////////////////////////////////////////////
+template <class Distribution>
+bool RangeCache::LoadDistribution(const char* text, StdDeck_CardMask dead, int holeCards,
+    const OrderingTable* ordering, Distribution& distribution)
+{
+    if (!s_enabled)
+        return false;
+
+    string normal = Normalize(text);
+    uint64_t deadBits = CardConverter::PokerEvalToBits(dead);
+    uint64_t key = GetKey(holeCards, normal, deadBits, ordering);
+
+    string path;
+    {
+        lock_guard<mutex> lock(s_cacheLock);
+        if (!s_enabled || !HasKey(key))
+            return false;
+        path = GetPath(s_directory, key);
+    }
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        lock_guard<mutex> lock(s_cacheLock);
+        RemoveKey(key);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(RangeCacheHeader)) {
+        close(fd);
+        return false;
+    }
+
+    size_t length = (size_t)st.st_size;
+    void* base = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file referenced
+    if (base == MAP_FAILED)
+        return false;
+
+    const RangeCacheHeader* header = (const RangeCacheHeader*)base;
+    const uint64_t* bits = (const uint64_t*)(header + 1);
+    const char* stored = NULL;
+    const char* name = ordering ? ordering->GetName() : "";
+    bool valid = (memcmp(header->magic, RANGE_CACHE_MAGIC, 4) == 0 &&
+                  header->version == RANGE_CACHE_VERSION &&
+                  header->holeCards == (uint32_t)holeCards &&
+                  header->weighted <= 1 &&
+                  memchr(header->ordering, '\0', sizeof(header->ordering)) != NULL);
+
+    if (valid) {
+        uint64_t expected = (uint64_t)sizeof(RangeCacheHeader) + (uint64_t)header->count * sizeof(uint64_t) * (1 + header->weighted) + header->textSize;
+        valid = (expected == length);
+        stored = (const char*)base + sizeof(RangeCacheHeader) + (size_t)header->count * sizeof(uint64_t) * (1 + header->weighted);
+    }
+
+    bool same = valid && header->key == key && header->dead == deadBits &&
+        strcmp(header->ordering, name) == 0 && normal.compare(0, string::npos, stored, header->textSize) == 0;
+
+    vector<StdDeck_CardMask> hands;
+    vector<double> handWeights;
+    if (same) {
+        hands.resize(header->count);
+        for (uint32_t i = 0; valid && i < header->count; i++) {
+            hands[i] = CardConverter::BitsToPokerEval(bits[i]);
+            valid = (__builtin_popcountll(bits[i]) == holeCards && (bits[i] & deadBits) == 0 &&
+                     (i == 0 || hands[i-1].cards_n < hands[i].cards_n));
+        }
+        if (header->weighted) {
+            const double* weights = (const double*)(bits + header->count);
+            handWeights.assign(weights, weights + header->count);
+            for (uint32_t i = 0; valid && i < header->count; i++)
+                valid = (handWeights[i] > 0.0 && handWeights[i] <= DBL_MAX);
+        }
+    }
+    munmap(base, length);
+
+    if (!valid) {
+        unlink(path.c_str());
+        lock_guard<mutex> lock(s_cacheLock);
+        RemoveKey(key);
+        return false;
+    }
+    if (!same)
+        return false;
+
+    distribution.m_hands.swap(hands);
+    distribution.m_weights.swap(handWeights);
+    distribution.m_handText = text;
+    distribution.m_error.Clear();
+    distribution.m_aliasValid = false;
+    distribution.SetDeadCards(dead);
+    if (distribution.m_hands.size() == 1)
+        distribution.m_current = distribution.m_hands[0];
+
+    HANDDIST_COUNT(CacheHits, 1);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Written under a name of its own and renamed into place, so that a reader
+// in another process never maps a partly written entry.
+///////////////////////////////////////////////////////////////////////////////
+template <class Distribution>
+int RangeCache::StoreDistribution(const char* text, StdDeck_CardMask dead, int holeCards,
+    const OrderingTable* ordering, const Distribution& distribution)
+{
+    if (!s_enabled || distribution.GetCount() < s_minimumHands || distribution.GetError().IsError())
+        return 0;
+
+    const char* name = ordering ? ordering->GetName() : "";
+    RangeCacheHeader header;
+    if (strlen(name) >= sizeof(header.ordering))
+        return 0;
+
+    string normal = Normalize(text);
+    uint64_t deadBits = CardConverter::PokerEvalToBits(dead);
+    uint64_t key = GetKey(holeCards, normal, deadBits, ordering);
+
+    string path;
+    {
+        lock_guard<mutex> lock(s_cacheLock);
+        if (!s_enabled || HasKey(key))
+            return 0;
+        path = GetPath(s_directory, key);
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RANGE_CACHE_MAGIC, 4);
+    header.version = RANGE_CACHE_VERSION;
+    header.key = key;
+    header.dead = deadBits;
+    header.holeCards = holeCards;
+    header.count = distribution.m_hands.size();
+    header.weighted = distribution.m_weights.empty() ? 0 : 1;
+    header.textSize = normal.size();
+    strcpy(header.ordering, name);
+
+    vector<uint64_t> bits(distribution.m_hands.size());
+    for (size_t i = 0; i < bits.size(); i++)
+        bits[i] = CardConverter::PokerEvalToBits(distribution.m_hands[i]);
+
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%d.%u.tmp", (int)getpid(), s_tempCount++);
+    string temp = path + suffix;
+
+    FILE* fp = fopen(temp.c_str(), "wb");
+    if (fp == NULL)
+        return 0;
+
+    bool ok = (fwrite(&header, sizeof(header), 1, fp) == 1 &&
+               fwrite(bits.data(), sizeof(uint64_t), bits.size(), fp) == bits.size());
+    if (ok && header.weighted)
+        ok = (fwrite(distribution.m_weights.data(), sizeof(double), bits.size(), fp) == bits.size());
+    if (ok)
+        ok = (fwrite(normal.data(), 1, normal.size(), fp) == normal.size());
+    if (fclose(fp) != 0)
+        ok = false;
+    if (ok)
+        ok = (rename(temp.c_str(), path.c_str()) == 0);
+    if (!ok) {
+        unlink(temp.c_str());
+        return 0;
+    }
+
+    lock_guard<mutex> lock(s_cacheLock);
+    AddKey(key);
+    HANDDIST_COUNT(CacheStores, 1);
+    return 1;
+}
@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+class HoldemHandDistribution;
+class OmahaHandDistribution;
+class OrderingTable;
+
+///////////////////////////////////////////////////////////////////////////////
+// Optional on-disk cache of instantiated ranges, so that the wide Omaha
+// ranges and percent slices a process builds don't have to be built again
+// after a restart. Once a directory is set, Init() of either distribution
+// looks the range up before parsing it and, on a miss, stores what it built:
+//
+//		RangeCache::SetDirectory("/data/local/tmp/ranges");
+//		OmahaHandDistribution range;
+//		range.Init("15%,AAxx", dead);		// parsed once, mapped afterwards
+//
+// An entry is keyed by a hash of the game, the range text (without empty
+// terms), the dead cards and the ordering table. Unlike DistributionCodec,
+// which keeps transfers small, an entry holds the hands as a plain array in
+// the order Init() leaves them, so a hit is a copy out of the mapped file
+// with no unranking or sorting. The stored text, dead cards and ordering are
+// checked against the ones asked for, so a hash collision is a miss rather
+// than a wrong range.
+//
+// Only ranges of at least GetMinimumHands() hands are stored; smaller ones
+// parse faster than a file can be opened. The keys on disk are listed once
+// by SetDirectory(), so a miss costs no system call; entries written later by
+// other processes are seen by the next SetDirectory(). Entries are written
+// to a temporary file and renamed into place, so any number of processes can
+// share a directory. Nothing is ever evicted; delete the files to clear it.
+///////////////////////////////////////////////////////////////////////////////
+class RangeCache
+{
+public:
+	// Use (and create, if it is missing) the directory path for the cache;
+	// NULL or "" turns the cache off. Returns 1 on success, 0 if the
+	// directory can't be created or read, leaving the cache off.
+	static int SetDirectory(const char* path);
+	static bool IsEnabled();
+
+	// Ranges of fewer hands are not stored (default 2000)
+	static void SetMinimumHands(int count);
+	static int GetMinimumHands();
+
+	// Replace the distribution with the cached instance of text with the
+	// given dead cards and the distribution's ordering table. Returns false,
+	// leaving the distribution alone, on a miss.
+	static bool Load(const char* text, StdDeck_CardMask dead, HoldemHandDistribution& distribution);
+	static bool Load(const char* text, StdDeck_CardMask dead, OmahaHandDistribution& distribution);
+
+	// Store a distribution just built by Init(text, dead), if it is large
+	// enough and not already cached. Returns 1 if it was written.
+	static int Store(const char* text, StdDeck_CardMask dead, const HoldemHandDistribution& distribution);
+	static int Store(const char* text, StdDeck_CardMask dead, const OmahaHandDistribution& distribution);
+
+	// Number of entries known in the directory
+	static int GetCount();
+
+private:
+	RangeCache(void) { }
+
+	static uint64_t GetKey(int holeCards, const string& text, uint64_t dead, const OrderingTable* ordering);
+	static string GetPath(const string& directory, uint64_t key);
+	static string Normalize(const char* text);
+
+	template <class Distribution>
+	static bool LoadDistribution(const char* text, StdDeck_CardMask dead, int holeCards,
+		const OrderingTable* ordering, Distribution& distribution);
+	template <class Distribution>
+	static int StoreDistribution(const char* text, StdDeck_CardMask dead, int holeCards,
+		const OrderingTable* ordering, const Distribution& distribution);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Range cache entry layout, one file named <key in hex>.phrc per range. All
+// numbers are in host byte order: a cache belongs to one device. The key
+// is hashed from host order numbers too, so a host of the other byte order
+// sharing the directory looks for other files, and a file it did open
+// would fail the version check.
+//
+//		RangeCacheHeader
+//		uint64_t hands[count]		(CardConverter::PokerEvalToBits() form)
+//		double weights[count]		(only if weighted)
+//		char text[textSize]			(the range text without empty terms, no NUL)
+///////////////////////////////////////////////////////////////////////////////
+#define RANGE_CACHE_MAGIC		"PHRC"
+#define RANGE_CACHE_VERSION		1
+
+struct RangeCacheHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t key;
+	uint64_t dead;			// CardConverter::PokerEvalToBits() form
+	uint32_t holeCards;
+	uint32_t count;			// hands
+	uint32_t weighted;		// 1 if the weights follow the hands
+	uint32_t textSize;
+	char ordering[16];		// name of the ordering table, resolved if it was the default
+};
@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <inlines/eval.h>
+#include "HandDistributions.h"
+#include "StratifiedSampler.h"
+#include "RandomEngine.h"
+
+static const int HALTON_BASES[] = { 2, 3, 5, 7, 11 };
+
+StratifiedSampler::StratifiedSampler(void)
+{
+    for (int k = 0; k < MAX_BOARD_CARDS; k++)
+        m_boardShift[k] = 0.0;
+}
+
+StratifiedSampler::~StratifiedSampler(void)
+{
+}
+
+void StratifiedSampler::AddPlayer(const vector<int>& hands, const vector<double>& weights)
+{
+    m_hands.push_back(hands);
+    m_cumulative.push_back(weights);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The R sequence for d players uses the powers of 1/g, where g is the only
+// positive root of x^(d+1) = x + 1 (the golden ratio for one player).
+///////////////////////////////////////////////////////////////////////////////
+void StratifiedSampler::Init(RandomEngine& rand)
+{
+    int players = m_hands.size();
+
+    double g = 2.0;
+    for (int i = 0; i < 30; i++)
+        g -= (pow(g, players + 1) - g - 1.0) / ((players + 1) * pow(g, players) - 1.0);
+
+    m_alpha.resize(players);
+    m_shift.resize(players);
+    for (int player = 0; player < players; player++) {
+        m_alpha[player] = fmod(pow(1.0 / g, player + 1), 1.0);
+        m_shift[player] = rand();
+
+        // Fisher-Yates, carrying the weights along
+        vector<int>& hands = m_hands[player];
+        vector<double>& weights = m_cumulative[player];
+        for (int i = (int)hands.size() - 1; i > 0; i--) {
+            int j = rand.Below(i + 1);
+            swap(hands[i], hands[j]);
+            if (!weights.empty())
+                swap(weights[i], weights[j]);
+        }
+
+        double total = 0.0;
+        for (size_t i = 0; i < weights.size(); i++)
+            total += weights[i];
+        double running = 0.0;
+        for (size_t i = 0; i < weights.size(); i++) {
+            running += weights[i];
+            weights[i] = running / total;
+        }
+    }
+
+    for (int k = 0; k < MAX_BOARD_CARDS; k++)
+        m_boardShift[k] = rand();
+}
+
+int StratifiedSampler::Hand(int player, int64_t trial) const
+{
+    const vector<int>& hands = m_hands[player];
+    if (hands.empty())
+        return -1;
+
+    double u = m_shift[player] + fmod(trial * m_alpha[player], 1.0);
+    if (u >= 1.0)
+        u -= 1.0;
+
+    const vector<double>& cumulative = m_cumulative[player];
+    size_t i = cumulative.empty() ? (size_t)(u * hands.size()) :
+        std::upper_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin();
+    return hands[min(i, hands.size() - 1)];
+}
+
+double StratifiedSampler::RadicalInverse(int base, uint64_t n)
+{
+    double inverse = 1.0 / base, scale = inverse, result = 0.0;
+    while (n > 0) {
+        result += (n % base) * scale;
+        n /= base;
+        scale *= inverse;
+    }
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The cards left are taken in deck order, so card k of the board splits the
+// remaining deck into strata by its Halton coordinate.
+///////////////////////////////////////////////////////////////////////////////
+void StratifiedSampler::DealBoard(int64_t trial, int count, StdDeck_CardMask& dead, StdDeck_CardMask& board) const
+{
+    int cards[StdDeck_N_CARDS];
+    int left = 0;
+    for (int card = 0; card < StdDeck_N_CARDS; card++) {
+        if (!StdDeck_CardMask_CARD_IS_SET(dead, card))
+            cards[left++] = card;
+    }
+
+    for (int k = 0; k < count && left > 0; k++) {
+        double u = m_boardShift[k] + RadicalInverse(HALTON_BASES[k], trial + 1);
+        if (u >= 1.0)
+            u -= 1.0;
+
+        int pick = min((int)(u * left), left - 1);
+        int card = cards[pick];
+        StdDeck_CardMask_SET(dead, card);
+        StdDeck_CardMask_SET(board, card);
+
+        memmove(cards + pick, cards + pick + 1, (left - pick - 1) * sizeof(int));
+        left--;
+    }
+}
@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+class RandomEngine;
+
+///////////////////////////////////////////////////////////////////////////////
+// Stratified (quasi-Monte Carlo) choice of the players' hands and the board
+// for the calculators' stratified mode.
+//
+// Hands: each player's live hands are put in a random order and laid end to
+// end on [0, 1), each taking a length proportional to its weight. Trial t
+// takes the hand under frac(shift + t * alpha), a Kronecker sequence with
+// one alpha per player from Roberts' R sequence, so over any n consecutive
+// trials every hand comes up in close to its share of them, in an order
+// that has nothing to do with how the range was written.
+//
+// Board: the k-th card still to come is picked from the cards left with
+// coordinate k of a Halton sequence (bases 2, 3, 5, 7, 11), randomly
+// shifted modulo 1 (Cranley-Patterson) so that runs with different seeds
+// are independent.
+//
+// A hand that collides with the hands dealt before it in the trial is left
+// to the calculator's usual collision handling.
+///////////////////////////////////////////////////////////////////////////////
+class StratifiedSampler
+{
+public:
+	StratifiedSampler();
+	~StratifiedSampler();
+
+	// Add the next player: the indices of the live hands in the player's
+	// distribution and their weights (empty if all are equal).
+	void AddPlayer(const vector<int>& hands, const vector<double>& weights);
+
+	// Shuffle the hands and draw the shifts, once all players are added.
+	void Init(RandomEngine& rand);
+
+	// The player's hand for the trial, or -1 if the player has no live hand.
+	int Hand(int player, int64_t trial) const;
+
+	// Add count cards not in dead to board (and to dead).
+	void DealBoard(int64_t trial, int count, StdDeck_CardMask& dead, StdDeck_CardMask& board) const;
+
+private:
+	enum { MAX_BOARD_CARDS = 5 };
+
+	static double RadicalInverse(int base, uint64_t n);
+
+	vector< vector<int> > m_hands;			// in random order
+	vector< vector<double> > m_cumulative;	// normalized running weights, empty if uniform
+	vector<double> m_alpha;
+	vector<double> m_shift;
+	double m_boardShift[MAX_BOARD_CARDS];
+};
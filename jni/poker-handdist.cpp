@@ -1 +1,257 @@
-#include <jni.h>
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2009 James Devlin
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// JNI bridge for com.pokereqcalc.poker_handdist.HandDist. Every call takes a
+// whole batch and reads and writes direct ByteBuffers in native byte order,
+// so a batch crosses JNI once and allocates no Java objects:
+//
+//		- strings are ASCII, each terminated by a '\0', packed back to back
+//		- cards are 64-bit masks with bit 13 * suit + rank set for each card
+//		  (rank 0 = deuce .. 12 = ace; suits hearts, diamonds, clubs, spades),
+//		  which is poker-eval's card index
+//		- results are 32-bit ints, 64-bit longs and doubles
+//
+// The game is an EquityJob::Game (0 Hold'em, 1 Omaha, 2 Omaha Hi/Lo).
+//
+// Nothing here is Android specific; on Linux the library builds against a
+// desktop JDK and runs under a plain JVM, e.g.
+/*
+		g++ -std=c++11 -O2 -shared -fPIC -pthread -I$JAVA_HOME/include \
+			-I$JAVA_HOME/include/linux -I<poker-eval>/include *.cpp \
+			-L<poker-eval>/lib -lpoker-eval -o libpoker-handdist.so
+*/
+// tools/HandDistCheck.java runs both calls through it from the host JVM.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <jni.h>
+#include <new>
+#include <system_error>
+#include <inlines/eval_omaha.h>
+#include "HandDistributions.h"
+#include "HoldemHandDistribution.h"
+#include "OmahaHandDistribution.h"
+#include "EquityJob.h"
+#include "CardConverter.h"
+
+// Most players an equity result has room for
+static const int MAX_PLAYERS = 10;
+
+// Doubles per spot in an equity result: players, trials, the equities and
+// the standard errors
+static const int RESULT_SIZE = 2 + 2 * MAX_PLAYERS;
+
+///////////////////////////////////////////////////////////////////////////////
+// Address of a direct buffer holding at least size bytes, or NULL; size is
+// set to the buffer's capacity (0 for a NULL buffer).
+///////////////////////////////////////////////////////////////////////////////
+static void* BufferAddress(JNIEnv* env, jobject buffer, jlong& size)
+{
+    if (buffer == NULL) {
+        size = 0;
+        return NULL;
+    }
+
+    void* address = env->GetDirectBufferAddress(buffer);
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (address == NULL || capacity < size)
+        return NULL;
+    size = capacity;
+    return address;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The next '\0' terminated string of a packed buffer, or NULL if it runs
+// off the end.
+///////////////////////////////////////////////////////////////////////////////
+static const char* NextString(const char*& text, const char* end)
+{
+    const char* string = text;
+    const char* terminator = (const char*)memchr(text, '\0', end - text);
+    if (terminator == NULL)
+        return NULL;
+    text = terminator + 1;
+    return string;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Instantiate one range into hands[first..] and weights[first..], as far as
+// capacity allows. Returns the number of hands in the range.
+///////////////////////////////////////////////////////////////////////////////
+template <class Distribution>
+static int Instantiate(const char* range, StdDeck_CardMask dead, jlong* hands, jdouble* weights, jlong first, jlong capacity)
+{
+    Distribution distribution;
+    int count = distribution.Init(range, dead);
+
+    for (int i = 0; i < count && first + i < capacity; i++) {
+        if (hands != NULL)
+            hands[first + i] = (jlong)CardConverter::PokerEvalToBits(distribution.Get(i));
+        if (weights != NULL)
+            weights[first + i] = distribution.GetWeight(i);
+    }
+    return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Raise a Java exception of the named class, to be thrown when the native
+// call returns. C++ exceptions must not unwind through the JNI frames.
+///////////////////////////////////////////////////////////////////////////////
+static void Throw(JNIEnv* env, const char* className, const char* message)
+{
+    jclass type = env->FindClass(className);
+    if (type != NULL)
+        env->ThrowNew(type, message);
+}
+
+extern "C" {
+
+///////////////////////////////////////////////////////////////////////////////
+// long instantiate(int game, ByteBuffer ranges, int count, ByteBuffer dead,
+//                  ByteBuffer counts, ByteBuffer hands, ByteBuffer weights)
+//
+// Expand count packed ranges into their specific hands. dead (optional)
+// holds one card mask per range; its hands are left out of that range.
+// counts gets one int per range: the number of its hands, 0 if it could not
+// be parsed or is empty. hands (optional) gets every range's hand masks one
+// after the other, and weights (optional) their weights. Returns the total
+// number of hands, which may exceed what hands and weights hold (they then
+// get the first ones only), or -1 if a buffer is missing, too small or not
+// direct. Running out of memory throws OutOfMemoryError.
+///////////////////////////////////////////////////////////////////////////////
+JNIEXPORT jlong JNICALL Java_com_pokereqcalc_poker_1handdist_HandDist_instantiate(JNIEnv* env, jclass,
+    jint game, jobject ranges, jint count, jobject dead, jobject counts, jobject hands, jobject weights)
+{
+    jlong textSize = 0, deadSize = (jlong)count * sizeof(jlong), countsSize = (jlong)count * sizeof(jint);
+    jlong handsSize = 0, weightsSize = 0;
+    const char* text = (const char*)BufferAddress(env, ranges, textSize);
+    const jlong* deadBits = (const jlong*)BufferAddress(env, dead, deadSize);
+    jint* handCounts = (jint*)BufferAddress(env, counts, countsSize);
+    jlong* handBits = (jlong*)BufferAddress(env, hands, handsSize);
+    jdouble* handWeights = (jdouble*)BufferAddress(env, weights, weightsSize);
+
+    if (count < 0 || game < EquityJob::Holdem || game > EquityJob::OmahaHiLo || text == NULL || handCounts == NULL ||
+        (dead != NULL && deadBits == NULL) || (hands != NULL && handBits == NULL) || (weights != NULL && handWeights == NULL))
+        return -1;
+
+    jlong capacity = handBits != NULL ? handsSize / (jlong)sizeof(jlong) : weightsSize / (jlong)sizeof(jdouble);
+    if (handBits != NULL && handWeights != NULL)
+        capacity = min(capacity, weightsSize / (jlong)sizeof(jdouble));
+
+    const char* end = text + textSize;
+    jlong total = 0;
+    try {
+        for (int i = 0; i < count; i++) {
+            const char* range = NextString(text, end);
+            if (range == NULL)
+                return -1;
+
+            StdDeck_CardMask deadCards = CardConverter::BitsToPokerEval(deadBits != NULL ? (uint64_t)deadBits[i] : 0);
+            if (game == EquityJob::Holdem)
+                handCounts[i] = Instantiate<HoldemHandDistribution>(range, deadCards, handBits, handWeights, total, capacity);
+            else
+                handCounts[i] = Instantiate<OmahaHandDistribution>(range, deadCards, handBits, handWeights, total, capacity);
+            total += handCounts[i];
+        }
+    }
+    catch (std::bad_alloc&) {
+        Throw(env, "java/lang/OutOfMemoryError", "out of memory instantiating a range");
+        return -1;
+    }
+
+    return total;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// int equity(int game, ByteBuffer spots, int count, long trials, long budget,
+//            int threads, ByteBuffer results)
+//
+// Run count packed spots, each three strings: the ranges separated by '|',
+// the board and the dead cards (both may be empty). A spot runs trials
+// trials or, when budget is positive, for budget milliseconds, on up to
+// threads workers (0: EquityJob::GetDefaultThreads()). results gets
+// RESULT_SIZE doubles per spot: the number of players (0 on error or above
+// MAX_PLAYERS), the number of trials, MAX_PLAYERS equities and MAX_PLAYERS
+// standard errors. Returns the number of spots run, or -1 if a buffer is
+// missing, too small or not direct. Running out of memory throws
+// OutOfMemoryError, and a worker thread that can't be started
+// IllegalStateException.
+///////////////////////////////////////////////////////////////////////////////
+JNIEXPORT jint JNICALL Java_com_pokereqcalc_poker_1handdist_HandDist_equity(JNIEnv* env, jclass,
+    jint game, jobject spots, jint count, jlong trials, jlong budget, jint threads, jobject results)
+{
+    jlong textSize = 0, resultsSize = (jlong)count * RESULT_SIZE * sizeof(jdouble);
+    const char* text = (const char*)BufferAddress(env, spots, textSize);
+    jdouble* out = (jdouble*)BufferAddress(env, results, resultsSize);
+    if (count < 0 || game < EquityJob::Holdem || game > EquityJob::OmahaHiLo || text == NULL || out == NULL)
+        return -1;
+
+    if (threads < 1)
+        threads = EquityJob::GetDefaultThreads();
+
+    int run = 0;
+    try {
+        // One job for the batch, so its workers keep their calculators
+        EquityJob job((EquityJob::Game)game);
+        const char* end = text + textSize;
+        for (int spot = 0; spot < count; spot++, out += RESULT_SIZE) {
+            const char* hands = NextString(text, end);
+            const char* board = hands != NULL ? NextString(text, end) : NULL;
+            const char* dead = board != NULL ? NextString(text, end) : NULL;
+            if (dead == NULL)
+                return -1;
+
+            memset(out, 0, RESULT_SIZE * sizeof(jdouble));
+            if (std::count(hands, hands + strlen(hands), '|') >= MAX_PLAYERS)
+                continue;
+
+            double* equities = out + 2;
+            double* errors = out + 2 + MAX_PLAYERS;
+            int64_t spotTrials = 0;
+            int players;
+            if (budget > 0) {
+                players = job.Estimate(hands, board, dead, budget, threads, equities, errors, spotTrials);
+            }
+            else {
+                players = job.Start(hands, board, dead, trials, threads);
+                job.Wait();
+                if (players > 0)
+                    spotTrials = job.GetResults(equities, errors);
+            }
+
+            out[0] = players;
+            out[1] = (double)spotTrials;
+            run++;
+        }
+    }
+    catch (std::bad_alloc&) {
+        Throw(env, "java/lang/OutOfMemoryError", "out of memory running a spot");
+        return -1;
+    }
+    catch (std::system_error&) {
+        Throw(env, "java/lang/IllegalStateException", "could not start a worker thread");
+        return -1;
+    }
+
+    return run;
+}
+
+}
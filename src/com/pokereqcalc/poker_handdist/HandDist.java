@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+package com.pokereqcalc.poker_handdist;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+///////////////////////////////////////////////////////////////////////////////
+// Batched access to libpoker-handdist (see jni/poker-handdist.cpp). Each call
+// handles a whole batch through direct buffers, so there is one JNI crossing
+// per batch and no objects per hand. Allocate the buffers once with
+// allocate() and reuse them:
+//
+//      ByteBuffer ranges = HandDist.allocate(4096);
+//      HandDist.putString(ranges, "QQ+,AKs");
+//      HandDist.putString(ranges, "22+");
+//      long total = HandDist.instantiate(HandDist.HOLDEM, ranges, 2, null, counts, hands, null);
+//
+// Cards are longs with bit 13 * suit + rank set for each card (rank 0 is a
+// deuce, 12 an ace; suits hearts, diamonds, clubs, spades).
+///////////////////////////////////////////////////////////////////////////////
+public final class HandDist
+{
+    public static final int HOLDEM = 0;
+    public static final int OMAHA = 1;
+    public static final int OMAHA_HILO = 2;
+
+    // Doubles per spot written by equity(): players, trials, MAX_PLAYERS
+    // equities and MAX_PLAYERS standard errors
+    public static final int MAX_PLAYERS = 10;
+    public static final int RESULT_SIZE = 2 + 2 * MAX_PLAYERS;
+
+    static {
+        System.loadLibrary("poker-handdist");
+    }
+
+    private HandDist() {}
+
+    // A direct buffer in native byte order, as every call expects.
+    public static ByteBuffer allocate(int bytes) {
+        return ByteBuffer.allocateDirect(bytes).order(ByteOrder.nativeOrder());
+    }
+
+    // Append an ASCII string and its terminating '\0' to a packed buffer.
+    public static void putString(ByteBuffer buffer, String text) {
+        for (int i = 0; i < text.length(); i++)
+            buffer.put((byte)text.charAt(i));
+        buffer.put((byte)0);
+    }
+
+    // Expand count packed ranges into their specific hands. dead (optional)
+    // holds a card mask per range; counts gets the number of hands of each
+    // range (0 if it could not be parsed or is empty); hands and weights
+    // (both optional) get the hands of every range one after the other and
+    // their weights. Returns the total number of hands, which may be more
+    // than hands holds, or -1 if a buffer is missing, short or not direct.
+    // Throws OutOfMemoryError if the native side runs out of memory.
+    public static native long instantiate(int game, ByteBuffer ranges, int count, ByteBuffer dead,
+            ByteBuffer counts, ByteBuffer hands, ByteBuffer weights);
+
+    // Run count packed spots of three strings each (ranges separated by '|',
+    // board, dead cards) for trials trials or, when budget is positive, for
+    // budget milliseconds, on up to threads threads (0 for one per big
+    // core). results gets RESULT_SIZE doubles per spot. Returns the number
+    // of spots run, or -1 if a buffer is missing, short or not direct.
+    // Throws OutOfMemoryError if the native side runs out of memory and
+    // IllegalStateException if a worker thread can't be started; results
+    // then holds the spots run before the failure.
+    public static native int equity(int game, ByteBuffer spots, int count, long trials, long budget,
+            int threads, ByteBuffer results);
+}
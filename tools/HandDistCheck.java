@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+import java.nio.ByteBuffer;
+
+import com.pokereqcalc.poker_handdist.HandDist;
+
+///////////////////////////////////////////////////////////////////////////////
+// Host tool: load libpoker-handdist into a desktop JVM and round-trip direct
+// buffers through both HandDist calls: ranges, dead cards and weights in,
+// hand counts, card masks, weights and equities out. Also checks that short
+// and non-direct buffers are refused with -1.
+//
+// Build the library on the host as described in jni/poker-handdist.cpp, then
+// from this directory, e.g.
+/*
+		javac -d /tmp/handdist ../src/com/pokereqcalc/poker_handdist/HandDist.java \
+			HandDistCheck.java
+		java -Djava.library.path=../jni -cp /tmp/handdist HandDistCheck
+*/
+// Usage: HandDistCheck (exits with 1 if any check fails)
+///////////////////////////////////////////////////////////////////////////////
+public final class HandDistCheck
+{
+    private static int failures = 0;
+
+    private static void check(String name, boolean ok) {
+        System.out.println(String.format("%-16s %s", name, ok ? "ok" : "FAIL"));
+        if (!ok)
+            failures++;
+    }
+
+    // The mask of a card as text such as "Ah": bit 13 * suit + rank
+    private static long card(String text) {
+        int rank = "23456789TJQKA".indexOf(text.charAt(0));
+        int suit = "hdcs".indexOf(text.charAt(1));
+        return 1L << (13 * suit + rank);
+    }
+
+    public static void main(String[] args) {
+        ByteBuffer ranges = HandDist.allocate(256);
+        HandDist.putString(ranges, "AhKh");
+        HandDist.putString(ranges, "AA");
+        HandDist.putString(ranges, "KK:0.5");
+
+        ByteBuffer dead = HandDist.allocate(3 * 8);
+        dead.putLong(0, 0);
+        dead.putLong(8, card("As"));
+        dead.putLong(16, 0);
+
+        ByteBuffer counts = HandDist.allocate(3 * 4);
+        ByteBuffer hands = HandDist.allocate(16 * 8);
+        ByteBuffer weights = HandDist.allocate(16 * 8);
+        long total = HandDist.instantiate(HandDist.HOLDEM, ranges, 3, dead, counts, hands, weights);
+
+        // AhKh, the three aces left by the dead As, and six kings at half weight
+        check("counts", total == 10 && counts.getInt(0) == 1 && counts.getInt(4) == 3 && counts.getInt(8) == 6);
+        check("hand", hands.getLong(0) == (card("Ah") | card("Kh")));
+        boolean live = true, weighted = true;
+        for (int i = 1; i < 4; i++) {
+            long hand = hands.getLong(8 * i);
+            live &= Long.bitCount(hand) == 2 && (hand & card("As")) == 0;
+        }
+        for (int i = 0; i < 10; i++)
+            weighted &= weights.getDouble(8 * i) == (i < 4 ? 1.0 : 0.5);
+        check("dead cards", live);
+        check("weights", weighted);
+
+        check("short buffer", HandDist.instantiate(HandDist.HOLDEM, ranges, 3, dead, HandDist.allocate(8), hands, weights) == -1);
+        check("heap buffer", HandDist.instantiate(HandDist.HOLDEM, ranges, 3, dead, ByteBuffer.allocate(12), hands, weights) == -1);
+
+        // AhAd against KhKd is about 82.6%
+        ByteBuffer spots = HandDist.allocate(256);
+        HandDist.putString(spots, "AhAd|KhKd");
+        HandDist.putString(spots, "");
+        HandDist.putString(spots, "");
+        ByteBuffer results = HandDist.allocate(HandDist.RESULT_SIZE * 8);
+        int run = HandDist.equity(HandDist.HOLDEM, spots, 1, 100000, 0, 2, results);
+        double equity = results.getDouble(2 * 8);
+        check("equity", run == 1 && results.getDouble(0) == 2 && results.getDouble(8) > 0 && Math.abs(equity - 0.826) < 0.01);
+
+        System.exit(failures == 0 ? 0 : 1);
+    }
+}
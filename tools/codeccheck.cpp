@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Host tool: round-trip ranges of both games through DistributionCodec and
+// check that each decoded distribution is the one that was encoded: the same
+// hands in the same order, the same weights, text, ordering table and live
+// count, and the same hands drawn by a seeded Choose(). Also checks that
+// truncated input and input of the other game are refused, and that ranges
+// with infinite or NaN weights are refused before they get this far.
+//
+// The ranges cover both hand set encodings (runs and raw words), weighted
+// and unweighted ranges, dead cards and a non-default ordering table.
+//
+// Build on the host against poker-eval, e.g.
+/*
+		g++ -std=c++11 -O2 -pthread -I../jni -I<poker-eval>/include codeccheck.cpp \
+			../jni/AliasTable.cpp ../jni/Card.cpp ../jni/CardConverter.cpp \
+			../jni/DistributionCodec.cpp ../jni/HandBitset.cpp ../jni/HandDistMetrics.cpp \
+			../jni/HoldemAgnosticHand.cpp ../jni/HoldemHandDistribution.cpp \
+			../jni/OmahaAgnosticHand.cpp ../jni/OmahaHandDistribution.cpp \
+			../jni/OrderingTables.cpp ../jni/ParseError.cpp ../jni/RandomEngine.cpp \
+			../jni/RangeCache.cpp -L<poker-eval>/lib -lpoker-eval -o codeccheck
+*/
+// Usage: codeccheck (exits with 1 if any check fails)
+///////////////////////////////////////////////////////////////////////////////
+
+#include <inlines/eval_omaha.h>
+#include <cstdio>
+#include "HandDistributions.h"
+#include "HoldemHandDistribution.h"
+#include "OmahaHandDistribution.h"
+#include "DistributionCodec.h"
+#include "CardConverter.h"
+#include "OrderingTables.h"
+#include "RandomEngine.h"
+
+static int s_failures = 0;
+
+static void Fail(const char* text, const char* what)
+{
+    printf("%-28s FAIL: %s\n", text, what);
+    s_failures++;
+}
+
+template <class Distribution>
+static void RoundTrip(const char* text, const char* dead, const OrderingTable* ordering)
+{
+    Distribution original(text, CardConverter::TextToPokerEval(dead), ordering);
+    vector<uint8_t> bytes;
+    size_t size = DistributionCodec::Encode(original, bytes);
+
+    Distribution copy;
+    if (!DistributionCodec::Decode(bytes.data(), bytes.size(), copy))
+        return Fail(text, "not decoded");
+
+    if (copy.GetCount() != original.GetCount() || copy.GetLiveCount() != original.GetLiveCount())
+        return Fail(text, "hand count");
+    if (strcmp(copy.GetText(), original.GetText()) != 0)
+        return Fail(text, "text");
+    if (copy.GetOrdering() != original.GetOrdering())
+        return Fail(text, "ordering");
+    if (copy.IsWeighted() != original.IsWeighted())
+        return Fail(text, "weighted");
+    for (int i = 0; i < original.GetCount(); i++) {
+        if (copy.Get(i).cards_n != original.Get(i).cards_n)
+            return Fail(text, "hands");
+        if (copy.GetWeight(i) != original.GetWeight(i))
+            return Fail(text, "weights");
+    }
+
+    // The dead cards only show in the hands drawn
+    StdDeck_CardMask none;
+    StdDeck_CardMask_RESET(none);
+    PhiloxEngine first(7), second(7);
+    for (int i = 0; i < 10000; i++) {
+        bool collision;
+        if (original.Choose(none, collision, first).cards_n != copy.Choose(none, collision, second).cards_n)
+            return Fail(text, "seeded Choose()");
+    }
+
+    for (size_t length = 0; length < bytes.size(); length++) {
+        Distribution truncated;
+        if (DistributionCodec::Decode(bytes.data(), length, truncated))
+            return Fail(text, "truncated input decoded");
+    }
+
+    printf("%-28s ok (%d hands, %u bytes)\n", text, original.GetCount(), (unsigned)size);
+}
+
+// A weight that can't be sampled (infinite, NaN) must be refused, and what
+// is kept of the range (rest: the Hold'em parser skips the term, the Omaha
+// one drops the range) must round-trip
+template <class Distribution>
+static void BadWeight(const char* text, const char* rest)
+{
+    Distribution distribution(text);
+    if (distribution.GetError().code != ParseError::BadWeight)
+        return Fail(text, "weight accepted");
+    if (distribution.GetCount() != Distribution(rest).GetCount())
+        return Fail(text, "hand count");
+    RoundTrip<Distribution>(text, "", NULL);
+}
+
+int main()
+{
+    const OrderingTable* holdem6Max = OrderingTables::Get(OrderingTables::Holdem6Max);
+    RoundTrip<HoldemHandDistribution>("QQ+,AKs", "", NULL);
+    RoundTrip<HoldemHandDistribution>("AhKh", "", NULL);
+    RoundTrip<HoldemHandDistribution>("XxXx", "AhKd", NULL);
+    RoundTrip<HoldemHandDistribution>("15%,AK:0.5,22:0.25", "AhKd", holdem6Max);
+
+    const OrderingTable* omaha6Max = OrderingTables::Get(OrderingTables::Omaha6Max);
+    RoundTrip<OmahaHandDistribution>("[AK]xx", "", NULL);
+    RoundTrip<OmahaHandDistribution>("XXXX", "AhKd", NULL);
+    RoundTrip<OmahaHandDistribution>("15%", "", omaha6Max);
+    RoundTrip<OmahaHandDistribution>("AAxx:0.5,[AK]xx/ds,KKxx", "AhKd", NULL);
+    RoundTrip<OmahaHandDistribution>("40-60%", "", NULL);
+
+    BadWeight<HoldemHandDistribution>("AA:inf,KK", "KK");
+    BadWeight<HoldemHandDistribution>("AA:nan,KK", "KK");
+    BadWeight<HoldemHandDistribution>("AA:1e999,KK", "KK");
+    BadWeight<OmahaHandDistribution>("AAxx:1.0e999,KKxx", "");
+
+    // A distribution only decodes into its own game
+    OmahaHandDistribution omaha("AAxx");
+    vector<uint8_t> bytes;
+    DistributionCodec::Encode(omaha, bytes);
+    HoldemHandDistribution holdem;
+    if (DistributionCodec::Decode(bytes.data(), bytes.size(), holdem))
+        Fail("AAxx", "decoded as Hold'em");
+
+    return s_failures ? 1 : 0;
+}
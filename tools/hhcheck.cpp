@@ -0,0 +1,340 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Host tool: parse a few sample hands with HandHistoryParser and check what
+// comes out of them, then check that a file cut into pieces at every byte
+// offset parses into the same hands as the whole file.
+//
+//		PokerStars cash		byte order mark before it, a name with parentheses,
+//							an all-in raise, a showdown
+//		PokerStars MTT		blinds in chips, an uncalled bet
+//		GGPoker cash		hashed names, hand id with letters, an uncalled bet
+//		PokerStars PLO		Omaha hole cards, a hand mucked face up
+//		PokerStars stud		skipped
+//
+// Build on the host against poker-eval, e.g.
+/*
+		g++ -std=c++11 -O2 -I../jni -I<poker-eval>/include hhcheck.cpp \
+			../jni/Card.cpp ../jni/CardConverter.cpp ../jni/HandBitset.cpp \
+			../jni/HandHistory.cpp ../jni/HandRanking.cpp ../jni/HoldemAgnosticHand.cpp \
+			../jni/OmahaAgnosticHand.cpp ../jni/OrderingTables.cpp \
+			-L<poker-eval>/lib -lpoker-eval -o hhcheck
+*/
+// Usage: hhcheck (exits with 1 if any check fails)
+///////////////////////////////////////////////////////////////////////////////
+
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <inlines/eval.h>
+#include "HandDistributions.h"
+#include "HandHistory.h"
+#include "EquityJob.h"
+
+static const char SAMPLE[] =
+    "\xEF\xBB\xBF"
+    "PokerStars Hand #243582018392:  Hold'em No Limit ($0.05/$0.10 USD) - 2023/03/15 20:14:31 ET\n"
+    "Table 'Aludra IV' 6-max Seat #3 is the button\n"
+    "Seat 1: Villain (1) ($10.00 in chips)\n"
+    "Seat 2: hero ($12.35 in chips)\n"
+    "Seat 3: fish77 ($4.10 in chips)\n"
+    "Seat 5: regular ($10.52 in chips)\n"
+    "regular: posts small blind $0.05\n"
+    "Villain (1): posts big blind $0.10\n"
+    "*** HOLE CARDS ***\n"
+    "Dealt to hero [Ah Kd]\n"
+    "hero: raises $0.20 to $0.30\n"
+    "fish77: raises $3.80 to $4.10 and is all-in\n"
+    "regular: folds\n"
+    "Villain (1): folds\n"
+    "hero: calls $3.80\n"
+    "*** FLOP *** [2c 7d Jh]\n"
+    "*** TURN *** [2c 7d Jh] [Kc]\n"
+    "*** RIVER *** [2c 7d Jh Kc] [3s]\n"
+    "*** SHOW DOWN ***\n"
+    "hero: shows [Ah Kd] (a pair of Kings)\n"
+    "fish77: shows [Qs Qh] (a pair of Queens)\n"
+    "hero collected $8.17 from pot\n"
+    "*** SUMMARY ***\n"
+    "Total pot $8.35 | Rake $0.18\n"
+    "Board [2c 7d Jh Kc 3s]\n"
+    "Seat 1: Villain (1) (big blind) folded before Flop\n"
+    "Seat 2: hero showed [Ah Kd] and won ($8.17) with a pair of Kings\n"
+    "Seat 3: fish77 (button) showed [Qs Qh] and lost with a pair of Queens\n"
+    "Seat 5: regular (small blind) folded before Flop\n"
+    "\n\n\n"
+    "PokerStars Hand #243582100001: Tournament #3512345678, $5.00+$0.50 USD Hold'em No Limit - Level III (25/50) - 2023/03/15 20:20:02 ET\n"
+    "Table '3512345678 12' 9-max Seat #4 is the button\n"
+    "Seat 2: alpha (2940 in chips)\n"
+    "Seat 4: hero (1500 in chips)\n"
+    "Seat 7: beta (3560 in chips)\n"
+    "beta: posts small blind 25\n"
+    "alpha: posts big blind 50\n"
+    "*** HOLE CARDS ***\n"
+    "Dealt to hero [9s 9c]\n"
+    "hero: raises 100 to 150\n"
+    "beta: folds\n"
+    "alpha: folds\n"
+    "Uncalled bet (100) returned to hero\n"
+    "hero collected 125 from pot\n"
+    "hero: doesn't show hand\n"
+    "*** SUMMARY ***\n"
+    "Total pot 125 | Rake 0\n"
+    "Seat 2: alpha (big blind) folded before Flop\n"
+    "Seat 4: hero (button) collected (125)\n"
+    "Seat 7: beta (small blind) folded before Flop\n"
+    "\n\n\n"
+    "Poker Hand #HD1234567: Hold'em No Limit ($0.25/$0.5) - 2024/01/05 12:00:00\n"
+    "Table 'NLHGold12' 6-max Seat #1 is the button\n"
+    "Seat 1: 7a2b3c4d ($50 in chips)\n"
+    "Seat 2: Hero ($52.5 in chips)\n"
+    "Seat 3: 1f2e3d4c ($48.75 in chips)\n"
+    "Hero: posts small blind $0.25\n"
+    "1f2e3d4c: posts big blind $0.5\n"
+    "*** HOLE CARDS ***\n"
+    "Dealt to 7a2b3c4d \n"
+    "Dealt to Hero [Ts Td]\n"
+    "Dealt to 1f2e3d4c \n"
+    "7a2b3c4d: folds\n"
+    "Hero: raises $1.5 to $2\n"
+    "1f2e3d4c: calls $1.5\n"
+    "*** FLOP *** [8h 4c 2d]\n"
+    "Hero: bets $2.5\n"
+    "1f2e3d4c: folds\n"
+    "Uncalled bet ($2.5) returned to Hero\n"
+    "*** SHOWDOWN ***\n"
+    "Hero collected $3.8 from pot\n"
+    "*** SUMMARY ***\n"
+    "Total pot $4 | Rake $0.2 | Jackpot $0 | Bingo $0\n"
+    "Board [8h 4c 2d]\n"
+    "Seat 1: 7a2b3c4d (button) folded before Flop\n"
+    "Seat 2: Hero (small blind) won ($3.8)\n"
+    "Seat 3: 1f2e3d4c (big blind) folded on the Flop\n"
+    "\n\n"
+    "PokerStars Hand #243590000017:  Omaha Pot Limit ($0.10/$0.25 USD) - 2023/03/16 21:02:11 ET\n"
+    "Table 'Pherkad' 6-max Seat #1 is the button\n"
+    "Seat 1: anna.b ($25.00 in chips)\n"
+    "Seat 2: zed ($31.40 in chips)\n"
+    "Seat 3: hero ($25.00 in chips)\n"
+    "zed: posts small blind $0.10\n"
+    "hero: posts big blind $0.25\n"
+    "*** HOLE CARDS ***\n"
+    "Dealt to hero [As Ad 8c 7c]\n"
+    "anna.b: raises $0.60 to $0.85\n"
+    "zed: folds\n"
+    "hero: calls $0.60\n"
+    "*** FLOP *** [Ac 9h 2s]\n"
+    "hero: checks\n"
+    "anna.b: bets $1.20\n"
+    "hero: calls $1.20\n"
+    "*** TURN *** [Ac 9h 2s] [5d]\n"
+    "hero: checks\n"
+    "anna.b: checks\n"
+    "*** RIVER *** [Ac 9h 2s 5d] [Kh]\n"
+    "hero: bets $3\n"
+    "anna.b: calls $3\n"
+    "*** SHOW DOWN ***\n"
+    "hero: shows [As Ad 8c 7c] (three of a kind, Aces)\n"
+    "anna.b: mucks hand\n"
+    "hero collected $9.62 from pot\n"
+    "*** SUMMARY ***\n"
+    "Total pot $10.20 | Rake $0.58\n"
+    "Board [Ac 9h 2s 5d Kh]\n"
+    "Seat 1: anna.b (button) mucked [Kd Kc Qh Js]\n"
+    "Seat 2: zed (small blind) folded before Flop\n"
+    "Seat 3: hero (big blind) showed [As Ad 8c 7c] and won ($9.62) with three of a kind, Aces\n"
+    "\n\n\n"
+    "PokerStars Hand #243590000100:  7 Card Stud Limit ($0.10/$0.20 USD) - 2023/03/16 21:05:00 ET\n"
+    "Table 'Zaniah' 8-max\n"
+    "Seat 1: a1 ($5.00 in chips)\n"
+    "Seat 2: b2 ($5.00 in chips)\n"
+    "a1: posts the ante $0.02\n"
+    "b2: posts the ante $0.02\n"
+    "*** 3rd STREET ***\n"
+    "Dealt to a1 [Xx Xx 9s]\n"
+    "a1: folds\n"
+    "*** SUMMARY ***\n"
+    "Seat 2: b2 collected ($0.04)\n";
+
+// What the checks need of a hand, copied out of the callback
+struct Hand
+{
+    HandRecord record;
+    vector<string> names;
+    string line;		// one line summary, to compare parses
+};
+
+static int s_failures = 0;
+
+static void Check(const char* name, bool ok)
+{
+    if (!ok) {
+        printf("%-28s FAIL\n", name);
+        s_failures++;
+    }
+}
+
+static bool OnHand(const HandRecord& record, void* context)
+{
+    vector<Hand>& hands = *(vector<Hand>*)context;
+    hands.push_back(Hand());
+    Hand& hand = hands.back();
+    hand.record = record;
+
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%llu %d %d %lld/%lld %llx", (unsigned long long)record.id, record.site, record.game,
+        (long long)record.smallBlind, (long long)record.bigBlind, (unsigned long long)record.board.cards_n);
+    hand.line = buffer;
+    for (int i = 0; i < record.playerCount; i++) {
+        const HandPlayer& player = record.players[i];
+        hand.names.push_back(string(player.name, player.nameLength));
+        snprintf(buffer, sizeof(buffer), " | %s %lld %lld %d %d", hand.names.back().c_str(), (long long)player.stack,
+            (long long)player.won, player.flags, player.handIndex);
+        hand.line += buffer;
+    }
+    for (size_t i = 0; i < record.actions.size(); i++) {
+        const HandAction& action = record.actions[i];
+        snprintf(buffer, sizeof(buffer), " %d:%d:%d:%lld%s", action.player, action.street, action.type,
+            (long long)action.amount, action.allIn ? "!" : "");
+        hand.line += buffer;
+    }
+    return true;
+}
+
+static string Lines(const vector<Hand>& hands)
+{
+    string lines;
+    for (size_t i = 0; i < hands.size(); i++)
+        lines += hands[i].line + "\n";
+    return lines;
+}
+
+// Index of the action of the given type by the named player, or -1
+static int FindAction(const Hand& hand, const char* name, int type)
+{
+    for (size_t i = 0; i < hand.record.actions.size(); i++) {
+        const HandAction& action = hand.record.actions[i];
+        if (action.type == type && hand.names[action.player] == name)
+            return (int)i;
+    }
+    return -1;
+}
+
+static int FindPlayer(const Hand& hand, const char* name)
+{
+    for (size_t i = 0; i < hand.names.size(); i++) {
+        if (hand.names[i] == name)
+            return (int)i;
+    }
+    return -1;
+}
+
+static void CheckSample(const vector<Hand>& hands, int64_t count, int64_t skipped)
+{
+    Check("hand count", count == 4 && hands.size() == 4);
+    Check("stud skipped", skipped == 1);
+    if (hands.size() != 4)
+        return;
+
+    // PokerStars cash, after the byte order mark
+    const Hand& cash = hands[0];
+    Check("cash id", cash.record.id == 243582018392ULL && cash.record.site == HandRecord::PokerStars);
+    Check("cash game", cash.record.game == EquityJob::Holdem && cash.record.maxSeats == 6 && cash.record.button == 3);
+    Check("cash blinds", cash.record.smallBlind == 5 && cash.record.bigBlind == 10);
+    Check("cash board", cash.record.boardCards == 5);
+    int villain = FindPlayer(cash, "Villain (1)");
+    Check("name with parentheses", villain == 0 && cash.record.players[0].stack == 1000);
+    int allIn = FindAction(cash, "fish77", HandAction::Raise);
+    Check("all-in raise", allIn >= 0 && cash.record.actions[allIn].allIn && cash.record.actions[allIn].amount == 410);
+    int hero = FindPlayer(cash, "hero");
+    Check("cash winner", hero >= 0 && cash.record.players[hero].won == 817 &&
+        cash.record.players[hero].flags == (HandPlayer::Dealt | HandPlayer::Shown | HandPlayer::Won));
+    int fish = FindPlayer(cash, "fish77");
+    Check("cash shown", fish >= 0 && cash.record.players[fish].flags == HandPlayer::Shown && cash.record.players[fish].handIndex >= 0);
+
+    // PokerStars tournament
+    const Hand& mtt = hands[1];
+    Check("mtt blinds", mtt.record.id == 243582100001ULL && mtt.record.smallBlind == 2500 && mtt.record.bigBlind == 5000);
+    int uncalled = FindAction(mtt, "hero", HandAction::Uncalled);
+    Check("mtt uncalled bet", uncalled >= 0 && mtt.record.actions[uncalled].amount == 10000);
+    hero = FindPlayer(mtt, "hero");
+    Check("mtt winner", hero >= 0 && mtt.record.players[hero].won == 12500 && mtt.record.players[hero].stack == 150000);
+
+    // GGPoker
+    const Hand& gg = hands[2];
+    Check("gg id", gg.record.id == 1234567 && gg.record.site == HandRecord::GGPoker);
+    Check("gg blinds", gg.record.smallBlind == 25 && gg.record.bigBlind == 50);
+    uncalled = FindAction(gg, "Hero", HandAction::Uncalled);
+    Check("gg uncalled bet", uncalled >= 0 && gg.record.actions[uncalled].amount == 250);
+    hero = FindPlayer(gg, "Hero");
+    Check("gg winner", hero >= 0 && gg.record.players[hero].won == 380 && gg.record.players[hero].stack == 5250);
+    Check("gg hidden cards", FindPlayer(gg, "7a2b3c4d") >= 0 && gg.record.players[FindPlayer(gg, "7a2b3c4d")].flags == 0);
+
+    // PokerStars Omaha
+    const Hand& plo = hands[3];
+    Check("plo game", plo.record.game == EquityJob::Omaha && plo.record.boardCards == 5);
+    hero = FindPlayer(plo, "hero");
+    int anna = FindPlayer(plo, "anna.b");
+    Check("plo shown", hero >= 0 && plo.record.players[hero].handIndex >= 0 && plo.record.players[hero].won == 962);
+    Check("plo mucked face up", anna >= 0 && plo.record.players[anna].flags == HandPlayer::Shown &&
+        plo.record.players[anna].handIndex >= 0);
+}
+
+int main()
+{
+    HandHistoryParser parser;
+    size_t size = sizeof(SAMPLE) - 1;
+
+    vector<Hand> memory;
+    int64_t count = parser.Parse(SAMPLE, size, OnHand, &memory);
+    CheckSample(memory, count, parser.GetSkipped());
+    string expected = Lines(memory);
+
+    char path[] = "/tmp/hhcheckXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || write(fd, SAMPLE, size) != (ssize_t)size) {
+        printf("can't write %s\n", path);
+        return 1;
+    }
+    close(fd);
+
+    vector<Hand> file;
+    parser.ParseFile(path, OnHand, &file);
+    Check("file and memory", Lines(file) == expected);
+
+    // Every cut, and pairs of cuts a few lines apart, must give every hand
+    // exactly once
+    int bad = 0;
+    for (size_t cut = 0; cut <= size; cut++) {
+        vector<Hand> pieces;
+        parser.ParseFile(path, 0, cut, OnHand, &pieces);
+        parser.ParseFile(path, cut, min(size, cut + 173), OnHand, &pieces);
+        parser.ParseFile(path, min(size, cut + 173), size, OnHand, &pieces);
+        if (Lines(pieces) != expected && bad++ == 0)
+            printf("pieces cut at %u and %u differ\n", (unsigned)cut, (unsigned)min(size, cut + 173));
+    }
+    Check("split file", bad == 0);
+    unlink(path);
+
+    if (s_failures == 0)
+        printf("%d hands, %u cuts ok\n", (int)memory.size(), (unsigned)size + 1);
+    return s_failures ? 1 : 0;
+}
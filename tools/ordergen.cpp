@@ -0,0 +1,258 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Host tool: generate an ordering table by ranking every starting hand class
+// on its equity against a number of random opponents.
+//
+// Only one hand per class is simulated. All hands of a class are the same
+// hand up to a permutation of the suits, so they have the same equity against
+// random hands: Hold'em has 169 classes (of 1,326 hands) and Omaha 16,432
+// suit isomorphic classes (of 270,725 hands). Classes are simulated in
+// parallel, one HoldemCalculator/OmahaCalculator per worker thread.
+//
+// The output is written in the format of he6maxordering.h and friends, and
+// optionally as a binary ordering file for OrderingTables::Load(). Omaha
+// classes are written as exact class expressions: suited cards grouped in
+// brackets and every other card in its own bracket, e.g. "[AK][A][2]" is an
+// As Ks Ah 2d style hand.
+//
+// Build on the host against poker-eval, e.g.
+/*
+		g++ -std=c++11 -O2 -pthread -I../jni -I<poker-eval>/include ordergen.cpp \
+			../jni/AliasTable.cpp ../jni/BoardEnumerator.cpp ../jni/Card.cpp \
+			../jni/CardConverter.cpp ../jni/EquityStatistics.cpp ../jni/RandomEngine.cpp \
+			../jni/HandBitset.cpp ../jni/HandCompatibility.cpp ../jni/StratifiedSampler.cpp \
+			../jni/OrderingTables.cpp ../jni/HoldemAgnosticHand.cpp \
+			../jni/HoldemHandDistribution.cpp ../jni/HoldemCalculator.cpp \
+			../jni/OmahaAgnosticHand.cpp ../jni/OmahaHandDistribution.cpp \
+			../jni/OmahaCalculator.cpp ../jni/PreflopTable.cpp ../jni/RangeCache.cpp \
+			-L<poker-eval>/lib -lpoker-eval -o ordergen
+*/
+// Usage: ordergen <he|oh|o8> <opponents> <trials> <threads> <array name>
+//                 <table name> <header out> [<binary out>]
+//
+//		ordergen oh 5 20000 8 OMAHA_6_MAX_ORDERING oh6 oh6maxordering.h oh6.bin
+///////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <thread>
+#include <map>
+#include <inlines/eval_omaha.h>
+#include "HandDistributions.h"
+#include "Card.h"
+#include "HoldemCalculator.h"
+#include "OmahaCalculator.h"
+#include "OrderingTables.h"
+
+struct HandClass
+{
+    string text;	// class as written to the ordering table
+    string hand;	// one specific hand of the class
+    double equity;
+};
+
+static string CardText(int card)
+{
+    string text;
+    text += Card::RankToChar(StdDeck_RANK(card));
+    text += Card::SuitToChar(StdDeck_SUIT(card));
+    return text;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The 169 Hold'em classes: pairs, suited and offsuit hands.
+///////////////////////////////////////////////////////////////////////////////
+static void HoldemClasses(vector<HandClass>& classes)
+{
+    for (int rank0 = Card::Ace; rank0 >= Card::Two; rank0--) {
+        for (int rank1 = rank0; rank1 >= Card::Two; rank1--) {
+            HandClass hc;
+            hc.equity = 0.0;
+            hc.text += Card::RankToChar(rank0);
+            hc.text += Card::RankToChar(rank1);
+            if (rank0 == rank1) {
+                hc.hand = CardText(StdDeck_MAKE_CARD(rank0, Card::Hearts)) + CardText(StdDeck_MAKE_CARD(rank1, Card::Diamonds));
+                classes.push_back(hc);
+                continue;
+            }
+
+            HandClass offsuit = hc;
+            hc.text += 's';
+            hc.hand = CardText(StdDeck_MAKE_CARD(rank0, Card::Hearts)) + CardText(StdDeck_MAKE_CARD(rank1, Card::Hearts));
+            classes.push_back(hc);
+
+            offsuit.text += 'o';
+            offsuit.hand = CardText(StdDeck_MAKE_CARD(rank0, Card::Hearts)) + CardText(StdDeck_MAKE_CARD(rank1, Card::Diamonds));
+            classes.push_back(offsuit);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Write an Omaha hand as its class: each suit's ranks, high to low, in
+// brackets; bigger suit groups first, then higher ranks first. Suits that
+// appear once become single card groups ("[A]") so every group is of a
+// different suit from the others, which is exactly how the parser reads it.
+///////////////////////////////////////////////////////////////////////////////
+static string OmahaClassText(const int suitRanks[4])
+{
+    vector<int> groups;
+    for (int suit = 0; suit < 4; suit++) {
+        if (suitRanks[suit])
+            groups.push_back(suitRanks[suit]);
+    }
+
+    std::sort(groups.begin(), groups.end(), [](int a, int b) {
+        int na = __builtin_popcount(a), nb = __builtin_popcount(b);
+        return na != nb ? na > nb : a > b;
+    });
+
+    string text;
+    for (size_t g = 0; g < groups.size(); g++) {
+        text += '[';
+        for (int rank = Card::Ace; rank >= Card::Two; rank--) {
+            if (groups[g] & (1 << rank))
+                text += Card::RankToChar(rank);
+        }
+        text += ']';
+    }
+
+    return text;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Collapse the 270,725 Omaha hands into suit isomorphic classes. The sorted
+// per-suit rank masks are the same for every hand of a class and differ
+// between classes, so they serve as the class key.
+///////////////////////////////////////////////////////////////////////////////
+static void OmahaClasses(vector<HandClass>& classes)
+{
+    map<uint64_t, size_t> seen;
+
+    for (int c0 = 0; c0 < StdDeck_N_CARDS; c0++)
+    for (int c1 = c0 + 1; c1 < StdDeck_N_CARDS; c1++)
+    for (int c2 = c1 + 1; c2 < StdDeck_N_CARDS; c2++)
+    for (int c3 = c2 + 1; c3 < StdDeck_N_CARDS; c3++) {
+        int cards[4] = { c0, c1, c2, c3 };
+        int suitRanks[4] = { 0, 0, 0, 0 };
+        for (int i = 0; i < 4; i++)
+            suitRanks[StdDeck_SUIT(cards[i])] |= 1 << StdDeck_RANK(cards[i]);
+
+        int sorted[4] = { suitRanks[0], suitRanks[1], suitRanks[2], suitRanks[3] };
+        std::sort(sorted, sorted + 4);
+        uint64_t key = ((uint64_t)sorted[3] << 39) | ((uint64_t)sorted[2] << 26) | ((uint64_t)sorted[1] << 13) | sorted[0];
+
+        if (seen.find(key) != seen.end())
+            continue;
+
+        HandClass hc;
+        hc.equity = 0.0;
+        hc.text = OmahaClassText(suitRanks);
+        for (int i = 0; i < 4; i++)
+            hc.hand += CardText(cards[i]);
+
+        seen[key] = classes.size();
+        classes.push_back(hc);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 8 || argc > 9) {
+        fprintf(stderr, "usage: %s <he|oh|o8> <opponents> <trials> <threads> <array name> <table name> <header out> [<binary out>]\n", argv[0]);
+        return 1;
+    }
+
+    string game = argv[1];
+    int opponents = atoi(argv[2]);
+    int64_t trials = atoll(argv[3]);
+    int threadCount = atoi(argv[4]);
+    const char* arrayName = argv[5];
+    const char* tableName = argv[6];
+    bool isHoldem = (game == "he");
+
+    if ((!isHoldem && game != "oh" && game != "o8") || opponents < 1 || opponents > 9 || trials < 1 || threadCount < 1) {
+        fprintf(stderr, "bad arguments\n");
+        return 1;
+    }
+
+    vector<HandClass> classes;
+    if (isHoldem)
+        HoldemClasses(classes);
+    else
+        OmahaClasses(classes);
+    fprintf(stderr, "%d classes\n", (int)classes.size());
+
+    atomic<size_t> next(0);
+    atomic<size_t> done(0);
+    vector<thread> workers;
+    for (int t = 0; t < threadCount; t++) {
+        workers.push_back(thread([&]() {
+            HoldemCalculator holdem;
+            OmahaCalculator omaha;
+            omaha.SetHiLo(game == "o8");
+            double results[10];
+
+            for (size_t i = next++; i < classes.size(); i = next++) {
+                string hands = classes[i].hand;
+                for (int o = 0; o < opponents; o++)
+                    hands += isHoldem ? "|XxXx" : "|XXXX";
+
+                int players = isHoldem ?
+                    holdem.Calculate(hands.c_str(), "", "", trials, results) :
+                    omaha.Calculate(hands.c_str(), "", "", trials, results);
+                classes[i].equity = players ? results[0] : 0.0;
+
+                size_t finished = ++done;
+                if (finished % (classes.size()/100 + 1) == 0)
+                    fprintf(stderr, "%d/%d\n", (int)finished, (int)classes.size());
+            }
+        }));
+    }
+
+    for (size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+
+    std::stable_sort(classes.begin(), classes.end(),
+        [](const HandClass& a, const HandClass& b) { return a.equity > b.equity; });
+
+    FILE* fp = fopen(argv[7], "w");
+    if (fp == NULL) {
+        fprintf(stderr, "cannot write %s\n", argv[7]);
+        return 1;
+    }
+    fprintf(fp, "const char *%s[] = {\n", arrayName);
+    for (size_t i = 0; i < classes.size(); i++)
+        fprintf(fp, "\"%s\"%s\n", classes[i].text.c_str(), i + 1 < classes.size() ? "," : "};");
+    fclose(fp);
+
+    if (argc == 9) {
+        vector<const char*> entries;
+        for (size_t i = 0; i < classes.size(); i++)
+            entries.push_back(classes[i].text.c_str());
+        if (!OrderingTables::Save(tableName, entries.data(), (int)entries.size(), argv[8])) {
+            fprintf(stderr, "cannot write %s\n", argv[8]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,64 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Host tool: write the compiled-in ordering tables as binary ordering files
+// (<dir>/he6.bin, <dir>/oh10.bin, ...) for builds that define
+// HANDDIST_EXTERNAL_OMAHA_ORDERINGS and load the tables at startup.
+//
+// Build on the host against poker-eval, e.g.
+/*
+		g++ -std=c++11 -O2 -I../jni -I<poker-eval>/include ordering2bin.cpp \
+			../jni/OrderingTables.cpp ../jni/HoldemAgnosticHand.cpp \
+			../jni/OmahaAgnosticHand.cpp ../jni/Card.cpp ../jni/CardConverter.cpp \
+			-L<poker-eval>/lib -lpoker-eval -o ordering2bin
+*/
+// Usage: ordering2bin <output dir>
+///////////////////////////////////////////////////////////////////////////////
+
+#include <inlines/eval_omaha.h>
+#include "HandDistributions.h"
+#include "OrderingTables.h"
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <output dir>\n", argv[0]);
+        return 1;
+    }
+
+    int failures = 0;
+    for (int id = 0; id < OrderingTables::BuiltinCount; id++) {
+        const OrderingTable* table = OrderingTables::Get(id);
+        if (table == NULL)
+            continue;
+
+        string path = string(argv[1]) + "/" + table->GetName() + ".bin";
+        if (OrderingTables::Save(table, path.c_str())) {
+            printf("%s: %d entries\n", path.c_str(), table->GetSize());
+        }
+        else {
+            fprintf(stderr, "%s: write failed\n", path.c_str());
+            failures++;
+        }
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,203 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Host tool: generate the heads-up preflop equity file read by
+// PreflopTable::Load().
+//
+// Every pair of hands that don't share a card is reduced to its class under
+// the 24 suit permutations, and one pair of each class is enumerated exactly
+// with HoldemCalculator::Enumerate (1,712,304 boards each). The class against
+// class table is the average over the combinations of each pair of classes.
+// Expect this to take a while: run it once per evaluator release with as many
+// threads as the machine has.
+//
+// Build on the host against poker-eval, e.g.
+/*
+		g++ -std=c++11 -O2 -pthread -I../jni -I<poker-eval>/include preflopgen.cpp \
+			../jni/AliasTable.cpp ../jni/BoardEnumerator.cpp ../jni/Card.cpp \
+			../jni/CardConverter.cpp ../jni/EquityStatistics.cpp ../jni/RandomEngine.cpp \
+			../jni/HandBitset.cpp ../jni/HandCompatibility.cpp ../jni/StratifiedSampler.cpp \
+			../jni/OrderingTables.cpp ../jni/HoldemAgnosticHand.cpp \
+			../jni/HoldemHandDistribution.cpp ../jni/HoldemCalculator.cpp \
+			../jni/OmahaAgnosticHand.cpp ../jni/OmahaHandDistribution.cpp \
+			../jni/PreflopTable.cpp ../jni/RangeCache.cpp \
+			-L<poker-eval>/lib -lpoker-eval -o preflopgen
+*/
+// Usage: preflopgen <threads> <output> [classes]
+//
+// With "classes" only the 169x169 class table is written (115KB instead of
+// 3.5MB); lookups are then exact for ranges made of whole classes only.
+//
+// The file is written in the byte order of the host, which must match the
+// devices that load it (every Android ABI is little-endian, as are x86
+// hosts).
+///////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <thread>
+#include <map>
+#include <cmath>
+#include <inlines/eval.h>
+#include "HandDistributions.h"
+#include "Card.h"
+#include "HandBitset.h"
+#include "HoldemCalculator.h"
+#include "PreflopTable.h"
+
+static string HandText(StdDeck_CardMask hand)
+{
+    string text;
+    for (int card = 0; card < StdDeck_N_CARDS; card++) {
+        if (StdDeck_CardMask_CARD_IS_SET(hand, card)) {
+            text += Card::RankToChar(StdDeck_RANK(card));
+            text += Card::SuitToChar(StdDeck_SUIT(card));
+        }
+    }
+    return text;
+}
+
+// Map the cards of suit s to suit perm[s]
+static uint64_t PermuteSuits(StdDeck_CardMask hand, const int perm[4])
+{
+    StdDeck_CardMask permuted;
+    StdDeck_CardMask_RESET(permuted);
+    for (int card = 0; card < StdDeck_N_CARDS; card++) {
+        if (StdDeck_CardMask_CARD_IS_SET(hand, card))
+            StdDeck_CardMask_SET(permuted, StdDeck_MAKE_CARD(StdDeck_RANK(card), perm[StdDeck_SUIT(card)]));
+    }
+    return permuted.cards_n;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3 || argc > 4 || (argc == 4 && strcmp(argv[3], "classes") != 0)) {
+        fprintf(stderr, "usage: %s <threads> <output> [classes]\n", argv[0]);
+        return 1;
+    }
+
+    int threadCount = atoi(argv[1]);
+    bool classesOnly = (argc == 4);
+    if (threadCount < 1) {
+        fprintf(stderr, "bad arguments\n");
+        return 1;
+    }
+
+    const int N = PreflopTable::ComboCount;
+
+    // All hands, indexed as in HandBitset
+    vector<StdDeck_CardMask> hands(N);
+    for (int c1 = 1; c1 < StdDeck_N_CARDS; c1++) {
+        for (int c0 = 0; c0 < c1; c0++) {
+            StdDeck_CardMask hand;
+            StdDeck_CardMask_RESET(hand);
+            StdDeck_CardMask_SET(hand, c0);
+            StdDeck_CardMask_SET(hand, c1);
+            hands[HandBitset::Index(hand, 2)] = hand;
+        }
+    }
+
+    vector< vector<int> > perms;
+    int perm[4] = { 0, 1, 2, 3 };
+    do {
+        perms.push_back(vector<int>(perm, perm + 4));
+    } while (std::next_permutation(perm, perm + 4));
+
+    // Class of every pair (i < j); -1 if the hands share a card
+    vector<int> pairClass(N * N, -1);
+    vector< pair<int, int> > representatives;
+    map< pair<uint64_t, uint64_t>, int > classes;
+    for (int i = 0; i < N; i++) {
+        for (int j = i + 1; j < N; j++) {
+            if (StdDeck_CardMask_ANY_SET(hands[i], hands[j]))
+                continue;
+
+            pair<uint64_t, uint64_t> key(hands[i].cards_n, hands[j].cards_n);
+            for (size_t p = 1; p < perms.size(); p++) {
+                pair<uint64_t, uint64_t> permuted(PermuteSuits(hands[i], &perms[p][0]), PermuteSuits(hands[j], &perms[p][0]));
+                if (permuted < key)
+                    key = permuted;
+            }
+
+            map< pair<uint64_t, uint64_t>, int >::iterator it = classes.find(key);
+            if (it == classes.end()) {
+                it = classes.insert(make_pair(key, (int)representatives.size())).first;
+                representatives.push_back(make_pair(i, j));
+            }
+            pairClass[i * N + j] = it->second;
+        }
+    }
+    fprintf(stderr, "%d pair classes\n", (int)representatives.size());
+
+    vector<double> equities(representatives.size());
+    atomic<size_t> next(0);
+    atomic<size_t> done(0);
+    vector<thread> workers;
+    for (int t = 0; t < threadCount; t++) {
+        workers.push_back(thread([&]() {
+            HoldemCalculator calculator;
+            double results[2];
+            for (size_t c = next++; c < representatives.size(); c = next++) {
+                string matchup = HandText(hands[representatives[c].first]) + "|" + HandText(hands[representatives[c].second]);
+                equities[c] = calculator.Enumerate(matchup.c_str(), "", "", results) == 2 ? results[0] : 0.5;
+
+                size_t finished = ++done;
+                if (finished % (representatives.size()/100 + 1) == 0)
+                    fprintf(stderr, "%d/%d\n", (int)finished, (int)representatives.size());
+            }
+        }));
+    }
+
+    for (size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+
+    vector<uint16_t> combos(N * N, 0);
+    vector<double> classSum(PreflopTable::ClassCount * PreflopTable::ClassCount, 0.0);
+    vector<int> classPairs(PreflopTable::ClassCount * PreflopTable::ClassCount, 0);
+    for (int i = 0; i < N; i++) {
+        for (int j = i + 1; j < N; j++) {
+            int c = pairClass[i * N + j];
+            if (c < 0)
+                continue;
+
+            double equity = equities[c];
+            combos[i * N + j] = (uint16_t)lround(equity * 65535.0);
+            combos[j * N + i] = (uint16_t)lround((1.0 - equity) * 65535.0);
+
+            int class0 = PreflopTable::ClassOf(hands[i]);
+            int class1 = PreflopTable::ClassOf(hands[j]);
+            classSum[class0 * PreflopTable::ClassCount + class1] += equity;
+            classPairs[class0 * PreflopTable::ClassCount + class1]++;
+            classSum[class1 * PreflopTable::ClassCount + class0] += 1.0 - equity;
+            classPairs[class1 * PreflopTable::ClassCount + class0]++;
+        }
+    }
+
+    vector<float> classEquity(classSum.size());
+    for (size_t c = 0; c < classSum.size(); c++)
+        classEquity[c] = classPairs[c] ? (float)(classSum[c] / classPairs[c]) : 0.5f;
+
+    if (!PreflopTable::Save(argv[2], classEquity.data(), classesOnly ? NULL : combos.data())) {
+        fprintf(stderr, "cannot write %s\n", argv[2]);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2014 Atin Malaviya
+//
+// DISCLAIMER OF WARRANTY
+//
+// This source code is provided "as is" and without warranties as to performance
+// or merchantability. The author and/or distributors of this source code may
+// have made statements about this source code. Any such statements do not
+// constitute warranties and shall not be relied on by the user in deciding
+// whether to use this source code.
+//
+// This source code is provided without any express or implied warranties
+// whatsoever. Because of the diversity of conditions and hardware under which
+// this source code may be used, no warranty of fitness for a particular purpose
+// is offered. The user is advised to test the source code thoroughly before
+// relying on it. The user must assume the entire risk of using the source code.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Host tool: check every RandomEngine against the known-answer vectors of its
+// reference implementation, and check that Seek() gives each engine streams
+// that differ, as the calculators need when a run is split across threads
+// or EquityJob chunks.
+//
+//		Philox			Random123 kat_vectors, philox4x32 10, key and counter 0
+//		Xoshiro256		xoshiro256starstar.c from state { 1, 2, 3, 4 }
+//		Pcg64			pcg-c check-pcg64, pcg64_srandom_r(42, 54)
+//		Mersenne		10000th output of MT19937 with seed 5489 (C++11 [rand.predef])
+//
+// Build on the host, e.g.
+/*
+		g++ -std=c++11 -O2 -I../jni -I<poker-eval>/include rngkat.cpp \
+			../jni/RandomEngine.cpp -o rngkat
+*/
+// Usage: rngkat (exits with 1 if any check fails)
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include "HandDistributions.h"
+#include "RandomEngine.h"
+
+static int s_failures = 0;
+
+static void Check(const char* name, const uint64_t* actual, const uint64_t* expected, int count)
+{
+    for (int i = 0; i < count; i++) {
+        if (actual[i] != expected[i]) {
+            printf("%-12s FAIL: output %d is %016llx, expected %016llx\n", name, i,
+                (unsigned long long)actual[i], (unsigned long long)expected[i]);
+            s_failures++;
+            return;
+        }
+    }
+    printf("%-12s ok\n", name);
+}
+
+int main()
+{
+    uint64_t out[5000];
+
+    // Each 64 bit number is the first two 32 bit words of a block
+    PhiloxEngine philox(0, 0);
+    philox.Fill(out, 2);
+    const uint64_t philoxExpected[] = { 0x6627e8d5e169c58dULL, 0xbc57ac4c9b00dbd8ULL };
+    Check("Philox", out, philoxExpected, 2);
+
+    Xoshiro256Engine xoshiro;
+    const uint64_t xoshiroState[4] = { 1, 2, 3, 4 };
+    xoshiro.SetState(xoshiroState);
+    xoshiro.Fill(out, 4);
+    const uint64_t xoshiroExpected[] = { 11520ULL, 0ULL, 1509978240ULL, 1215971899390074240ULL };
+    Check("Xoshiro256", out, xoshiroExpected, 4);
+
+    Pcg64Engine pcg;
+    pcg.SetState(0, 42, 0, 54);
+    pcg.Fill(out, 6);
+    const uint64_t pcgExpected[] = { 0x86b1da1d72062b68ULL, 0x1304aa46c9853d39ULL, 0xa3670e9e0dd50358ULL,
+        0xf9090e529a7dae00ULL, 0xc85b9fd837996f2cULL, 0x606121f8e3919196ULL };
+    Check("Pcg64", out, pcgExpected, 6);
+
+    // Outputs 9999 and 10000 are the halves of the 5000th number
+    MersenneEngine mersenne(5489);
+    mersenne.Fill(out, 5000);
+    const uint64_t mersenneExpected[] = { 4123659995ULL };
+    uint64_t mersenneActual[] = { out[4999] & 0xffffffffULL };
+    Check("Mersenne", mersenneActual, mersenneExpected, 1);
+
+    // Streams of one seed must not replay each other
+    for (int type = 0; type < RandomEngine::TypeCount; type++) {
+        RandomEngine* first = RandomEngine::Create(type, 42);
+        RandomEngine* second = RandomEngine::Create(type, 42);
+        first->Seek(0);
+        second->Seek(1024);
+        uint64_t a[4], b[4];
+        for (int i = 0; i < 4; i++) {
+            a[i] = first->Next64();
+            b[i] = second->Next64();
+        }
+        if (memcmp(a, b, sizeof(a)) == 0) {
+            printf("engine %d     FAIL: streams 0 and 1024 are the same\n", type);
+            s_failures++;
+        }
+        delete first;
+        delete second;
+    }
+
+    if (s_failures == 0)
+        printf("streams      ok\n");
+    return s_failures ? 1 : 0;
+}